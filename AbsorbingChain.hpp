@@ -0,0 +1,132 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cmath>
+#include <utility>
+
+#include "Types.hpp"
+#include "Prob.hpp"
+#include "State.hpp"
+#include "TransitionTable.hpp"
+#include "StateDistribution.hpp"
+
+/*
+Catch probability of "prefixActions, then repeatedActions again and again until the pokemon is caught or flees", without truncation.
+
+After the prefix, the battle is a Markov chain over (State, position in repeatedActions), plus the caught and fled absorbing states.
+x[(stateIdx, phase)], the probability to eventually catch the pokemon from there, is the solution of the linear system
+  x[(s, phase)] = P(catch) + sum of P(outcome) * x[(next s, phase + 1)] over the outcomes where the pokemon watches carefully
+The pokemon flees with at least 5% chance every turn, so the system always has a single solution.
+
+Only (State, phase) pairs reachable after the prefix are included: for Chansey and a block of 4 actions, a few hundred unknowns,
+solved with Gaussian elimination in a few milliseconds.
+The system is solved with double, because it needs divisions that Prob doesn't provide.
+*/
+struct AbsorbingChain
+{
+  static double GetCatchProb(const std::vector<PlayerAction>& prefixActions, const std::vector<PlayerAction>& repeatedActions,
+    const State& initialState = State())
+  {
+    TransitionTable table(initialState);
+    StateDistribution distribution(table);
+    for (auto playerAction : prefixActions)
+      distribution.ApplyAction(playerAction);
+
+    if (repeatedActions.empty())
+      return distribution.caughtProb.ToFloat();
+
+    // Index of every reachable (stateIdx, phase)
+    std::unordered_map<u32, size_t> unknownIdxByKey;
+    std::vector<std::pair<u16, size_t>> unknowns; // (stateIdx, phase)
+    auto GetUnknownIdx = [&](u16 stateIdx, size_t phase)
+    {
+      auto [it, inserted] = unknownIdxByKey.try_emplace((u32)(phase << 16 | stateIdx), unknowns.size());
+      if (inserted)
+        unknowns.emplace_back(stateIdx, phase);
+      return it->second;
+    };
+
+    for (const auto& entry : distribution.entries)
+      GetUnknownIdx(entry.stateIdx, 0);
+
+    // unknowns grows while new pairs are discovered
+    for (size_t i = 0; i < unknowns.size(); i++)
+    {
+      auto [stateIdx, phase] = unknowns[i];
+      PlayerAction playerAction = repeatedActions[phase];
+      auto end = table.EndOutcomes(stateIdx, playerAction);
+      for (auto outcome = table.BeginOutcomes(stateIdx, playerAction); outcome != end; outcome++)
+        if (outcome->pokemonAction == PokemonAction::watchCarefully)
+          GetUnknownIdx(outcome->nextStateIdx, (phase + 1) % repeatedActions.size());
+    }
+
+    // matrix * x = rhs, where matrix = I - P(watch carefully transitions) and rhs = P(catch)
+    size_t n = unknowns.size();
+    std::vector<double> matrix(n * n, 0);
+    std::vector<double> rhs(n, 0);
+    for (size_t i = 0; i < n; i++)
+    {
+      auto [stateIdx, phase] = unknowns[i];
+      PlayerAction playerAction = repeatedActions[phase];
+      size_t nextPhase = (phase + 1) % repeatedActions.size();
+
+      matrix[i * n + i] += 1;
+      auto end = table.EndOutcomes(stateIdx, playerAction);
+      for (auto outcome = table.BeginOutcomes(stateIdx, playerAction); outcome != end; outcome++)
+      {
+        if (outcome->pokemonAction == PokemonAction::caught)
+          rhs[i] += outcome->prob.ToFloat();
+        else if (outcome->pokemonAction == PokemonAction::watchCarefully)
+          matrix[i * n + unknownIdxByKey.at((u32)(nextPhase << 16 | outcome->nextStateIdx))] -= outcome->prob.ToFloat();
+      }
+    }
+
+    std::vector<double> x = Solve(matrix, rhs);
+
+    double catchProb = distribution.caughtProb.ToFloat();
+    for (const auto& entry : distribution.entries)
+      catchProb += entry.prob.ToFloat() * x[unknownIdxByKey.at(entry.stateIdx)];
+    return catchProb;
+  }
+
+private:
+  /* Gaussian elimination with partial pivoting. matrix is n*n, row-major. */
+  static std::vector<double> Solve(std::vector<double> matrix, std::vector<double> rhs)
+  {
+    size_t n = rhs.size();
+    for (size_t col = 0; col < n; col++)
+    {
+      size_t pivot = col;
+      for (size_t row = col + 1; row < n; row++)
+        if (std::abs(matrix[row * n + col]) > std::abs(matrix[pivot * n + col]))
+          pivot = row;
+      if (pivot != col)
+      {
+        for (size_t k = 0; k < n; k++)
+          std::swap(matrix[col * n + k], matrix[pivot * n + k]);
+        std::swap(rhs[col], rhs[pivot]);
+      }
+
+      for (size_t row = col + 1; row < n; row++)
+      {
+        double factor = matrix[row * n + col] / matrix[col * n + col];
+        if (factor == 0)
+          continue;
+        for (size_t k = col; k < n; k++)
+          matrix[row * n + k] -= factor * matrix[col * n + k];
+        rhs[row] -= factor * rhs[col];
+      }
+    }
+
+    std::vector<double> x(n);
+    for (size_t row = n; row-- > 0;)
+    {
+      double sum = rhs[row];
+      for (size_t k = row + 1; k < n; k++)
+        sum -= matrix[row * n + k] * x[k];
+      x[row] = sum / matrix[row * n + row];
+    }
+    return x;
+  }
+};
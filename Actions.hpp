@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "Types.hpp"
+
+/* Conversions between actionByTurn and the string format used by montecarlo.js. Ex: "TTLLL" is Bait, Bait, Ball, Ball, Ball */
+
+inline std::string ActionsToStr(const std::vector<PlayerAction>& actionByTurn)
+{
+  std::string str;
+  for (auto playerAction : actionByTurn)
+    str += playerAction == PlayerAction::ball ? 'L' : playerAction == PlayerAction::bait ? 'T' : 'R';
+  return str;
+}
+
+/* Characters other than L, T and R are ignored. */
+inline std::vector<PlayerAction> StrToActions(const std::string& str)
+{
+  std::vector<PlayerAction> actionByTurn;
+  for (char c : str)
+  {
+    if (c == 'L')
+      actionByTurn.push_back(PlayerAction::ball);
+    else if (c == 'T')
+      actionByTurn.push_back(PlayerAction::bait);
+    else if (c == 'R')
+      actionByTurn.push_back(PlayerAction::rock);
+  }
+  return actionByTurn;
+}
+
+struct RepeatedBlock
+{
+  /* Turn of the first repetition */
+  size_t begin = 0;
+  /* Turns per repetition */
+  size_t length = 0;
+  u64 repeatCount = 0;
+};
+
+/* Returns the block of at most maxLength actions that covers the most consecutive turns of actionByTurn by repeating itself,
+   the shortest one on ties. repeatCount is 0 if no block is repeated at least twice.
+   Ex: "LT" + "TLL" * 3 + "R" is { begin 2, length 3, repeatCount 3 }. With "LLLL", the block is "L" repeated 4 times. */
+inline RepeatedBlock FindRepeatedBlock(const std::vector<PlayerAction>& actionByTurn, size_t maxLength = 32)
+{
+  RepeatedBlock best;
+  for (size_t length = 1; length <= maxLength && length * 2 <= actionByTurn.size(); length++)
+  {
+    // Each run of turns where actionByTurn[turn] == actionByTurn[turn + length] repeats a block of length turns
+    size_t runBegin = 0;
+    while (runBegin + length < actionByTurn.size())
+    {
+      size_t runEnd = runBegin;
+      while (runEnd + length < actionByTurn.size() && actionByTurn[runEnd] == actionByTurn[runEnd + length])
+        runEnd++;
+
+      u64 repeatCount = (runEnd - runBegin + length) / length;
+      if (repeatCount >= 2 && repeatCount * length > best.repeatCount * best.length)
+        best = RepeatedBlock{ runBegin, length, repeatCount };
+      runBegin = runEnd + 1;
+    }
+  }
+  return best;
+}
+
+/* Returns actionByTurn with the rules of montecarlo.js for a player with <ballCount> balls: once actionByTurn is over,
+   the player keeps throwing balls, and the battle ends after the ballCount-th ball if the pokemon is neither caught nor fled,
+   so the actions after it never happen.
+   Every branch of the battle performs the same actions, so the number of balls left only depends on the turn:
+   the engines don't need it in State, and merging identical states still merges identical (State, balls left).
+   Ex: With 3 balls, "TLT" becomes "TLTLL" and "LLLLT" becomes "LLL". With ballCount 0, actionByTurn is returned as is. */
+inline std::vector<PlayerAction> ApplyBallCount(const std::vector<PlayerAction>& actionByTurn, int ballCount)
+{
+  if (ballCount == 0)
+    return actionByTurn;
+
+  std::vector<PlayerAction> actions;
+  int thrownBallCount = 0;
+  for (size_t turn = 0; thrownBallCount < ballCount; turn++)
+  {
+    PlayerAction playerAction = turn < actionByTurn.size() ? actionByTurn[turn] : PlayerAction::ball;
+    actions.push_back(playerAction);
+    if (playerAction == PlayerAction::ball)
+      thrownBallCount++;
+  }
+  return actions;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <vector>
+
+#include "Types.hpp"
+#include "TransitionTable.hpp"
+
+/*
+Result of throwing ballCount balls in a row, in closed form, instead of one turn at a time.
+
+A ball never branches: the pokemon is caught, flees, or watches carefully and the bait/rock counter decreases by 1.
+So from a given state, the states of a run of balls are known in advance, and once the counters reach 0 (after at most 6 balls),
+the state doesn't change anymore: every following ball has the same catch probability c and r = P(miss) * P(stay).
+The n balls thrown in that stable state catch the pokemon with c * (1 + r + ... + r^(n-1)), and the battle is still
+ongoing with r^n. Both are computed with O(log n) multiplications (see AddGeometricRun), so it works with any probability type.
+
+Ex: 1000 balls without bait/rock take ~40 multiplications instead of 1000 turns.
+*/
+template<typename P>
+struct BasicBallRun
+{
+  /* Probability that the pokemon is caught by one of the balls */
+  P caughtProb = P::ZERO;
+  /* Probability that the pokemon is neither caught nor fled after the last ball */
+  P ongoingProb = P::ONE;
+  /* State after the last ball, if ongoing */
+  u16 nextStateIdx = 0;
+
+  BasicBallRun() = default;
+
+  BasicBallRun(const BasicTransitionTable<P>& table, u16 stateIdx, u64 ballCount) :
+    nextStateIdx(stateIdx)
+  {
+    for (; ballCount > 0; ballCount--)
+    {
+      // Ball outcomes are caught, flee and watchCarefully
+      const typename BasicTransitionTable<P>::Outcome* catchOutcome = nullptr;
+      const typename BasicTransitionTable<P>::Outcome* watchOutcome = nullptr;
+      auto end = table.EndOutcomes(this->nextStateIdx, PlayerAction::ball);
+      for (auto outcome = table.BeginOutcomes(this->nextStateIdx, PlayerAction::ball); outcome != end; outcome++)
+      {
+        if (outcome->pokemonAction == PokemonAction::caught)
+          catchOutcome = outcome;
+        else if (outcome->pokemonAction == PokemonAction::watchCarefully)
+          watchOutcome = outcome;
+      }
+
+      if (watchOutcome->nextStateIdx == this->nextStateIdx)
+      {
+        this->AddGeometricRun(catchOutcome->prob, watchOutcome->prob, ballCount);
+        return;
+      }
+
+      this->caughtProb.Add(this->ongoingProb.MulNew(catchOutcome->prob));
+      this->ongoingProb.Mul(watchOutcome->prob);
+      this->nextStateIdx = watchOutcome->nextStateIdx;
+    }
+  }
+
+private:
+  /* ballCount balls in a stable state. sum = 1 + r + ... + r^(ballCount-1) and rPow = r^ballCount are built from the binary
+     digits of ballCount, with the sum and the power of blocks of 1, 2, 4, 8... balls: sum(a + b) = sum(a) + r^a * sum(b). */
+  void AddGeometricRun(const P& catchProb, const P& r, u64 ballCount)
+  {
+    P sum = P::ZERO;
+    P rPow = P::ONE;
+    P blockSum = P::ONE;
+    P blockRPow = r;
+    for (u64 k = ballCount; k > 0; k >>= 1)
+    {
+      if (k & 1)
+      {
+        sum.Add(rPow.MulNew(blockSum));
+        rPow.Mul(blockRPow);
+      }
+      if (k > 1)
+      {
+        blockSum.Add(blockRPow.MulNew(blockSum));
+        blockRPow.Mul(blockRPow);
+      }
+    }
+
+    P prob = this->ongoingProb.MulNew(catchProb);
+    prob.Mul(sum);
+    this->caughtProb.Add(prob);
+    this->ongoingProb.Mul(rPow);
+  }
+};
+
+/*
+BasicBallRun of every run of 2+ balls of actionByTurn, from every state, computed once so that engines that visit
+the same (turn, state) many times (the tree engine) only do a lookup.
+*/
+template<typename P>
+struct BasicBallRunTable
+{
+  BasicBallRunTable(const BasicTransitionTable<P>& table, const std::vector<PlayerAction>& actionByTurn) :
+    stateCount(table.states.size()),
+    runLengthByTurn(actionByTurn.size(), 0),
+    runOffsetByTurn(actionByTurn.size(), 0)
+  {
+    std::vector<int> ballCountFromTurn(actionByTurn.size() + 1, 0);
+    for (size_t turn = actionByTurn.size(); turn-- > 0;)
+      if (actionByTurn[turn] == PlayerAction::ball)
+        ballCountFromTurn[turn] = 1 + ballCountFromTurn[turn + 1];
+
+    /* Only the first turn of a run has entries in runs */
+    for (size_t turn = 0; turn < actionByTurn.size(); turn++)
+    {
+      bool isRunStart = turn == 0 || actionByTurn[turn - 1] != PlayerAction::ball;
+      if (!isRunStart || ballCountFromTurn[turn] < 2)
+        continue;
+      this->runLengthByTurn[turn] = ballCountFromTurn[turn];
+      this->runOffsetByTurn[turn] = this->runs.size();
+      for (size_t stateIdx = 0; stateIdx < this->stateCount; stateIdx++)
+        this->runs.push_back(BasicBallRun<P>(table, (u16)stateIdx, ballCountFromTurn[turn]));
+    }
+  }
+
+  /* Number of balls of the run that starts at <turn>, 0 if <turn> isn't the first ball of a run of 2+ balls */
+  int GetRunLength(size_t turn) const
+  {
+    return this->runLengthByTurn[turn];
+  }
+
+  /* <turn> must be the start of a run (GetRunLength(turn) != 0) */
+  const BasicBallRun<P>& GetRun(size_t turn, u16 stateIdx) const
+  {
+    return this->runs[this->runOffsetByTurn[turn] + stateIdx];
+  }
+
+private:
+  size_t stateCount;
+  std::vector<int> runLengthByTurn;
+  std::vector<size_t> runOffsetByTurn;
+  std::vector<BasicBallRun<P>> runs;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "Types.hpp"
+#include "Prob.hpp"
+#include "State.hpp"
+#include "TransitionTable.hpp"
+#include "StateDistribution.hpp"
+
+/*
+Evaluates many actionByTurn at once.
+
+The actions are stored in a prefix tree, where each edge is one action. The StateDistribution is advanced once per edge,
+so actions sharing a prefix only pay for that prefix once.
+Ex: For TTLLLTL and TTLLLTR, the turns of TTLLLT are only computed once.
+*/
+struct Batch
+{
+  /* Returns the catch probability of each actionByTurn, in the same order. */
+  static std::vector<Prob> GetCatchProbs(const std::vector<std::vector<PlayerAction>>& actionByTurnList, const State& initialState = State())
+  {
+    Batch batch(actionByTurnList);
+    TransitionTable table(initialState);
+
+    std::vector<Prob> catchProbs(actionByTurnList.size(), Prob::ZERO);
+    batch.Explore(0, StateDistribution(table), catchProbs);
+    return catchProbs;
+  }
+
+private:
+  static constexpr int NO_CHILD = -1;
+
+  struct TrieNode
+  {
+    /* Index of the child node for each PlayerAction (ball, bait, rock) */
+    int children[3] = { NO_CHILD, NO_CHILD, NO_CHILD };
+    /* Indexes of the actionByTurn that end at this node */
+    std::vector<size_t> actionByTurnIdxs;
+  };
+
+  /* nodes[0] is the root (no action performed) */
+  std::vector<TrieNode> nodes;
+
+  Batch(const std::vector<std::vector<PlayerAction>>& actionByTurnList)
+  {
+    this->nodes.emplace_back();
+
+    for (size_t i = 0; i < actionByTurnList.size(); i++)
+    {
+      int nodeIdx = 0;
+      for (auto playerAction : actionByTurnList[i])
+      {
+        int childIdx = this->nodes[nodeIdx].children[playerAction];
+        if (childIdx == NO_CHILD)
+        {
+          childIdx = (int)this->nodes.size();
+          this->nodes[nodeIdx].children[playerAction] = childIdx;
+          this->nodes.emplace_back();
+        }
+        nodeIdx = childIdx;
+      }
+      this->nodes[nodeIdx].actionByTurnIdxs.push_back(i);
+    }
+  }
+
+  /* Iterative, so that long actionByTurn don't overflow the call stack: a chain of single-child nodes advances the
+     distribution in place, and only the other children of branching nodes are kept on pending. */
+  void Explore(int rootIdx, const StateDistribution& rootDistribution, std::vector<Prob>& catchProbs) const
+  {
+    struct PendingNode
+    {
+      int nodeIdx;
+      StateDistribution distribution;
+    };
+    std::vector<PendingNode> pending;
+    pending.push_back({ rootIdx, rootDistribution });
+
+    while (!pending.empty())
+    {
+      int nodeIdx = pending.back().nodeIdx;
+      StateDistribution distribution = std::move(pending.back().distribution);
+      pending.pop_back();
+
+      while (true)
+      {
+        const TrieNode& node = this->nodes[nodeIdx];
+
+        for (size_t actionByTurnIdx : node.actionByTurnIdxs)
+          catchProbs[actionByTurnIdx] = distribution.caughtProb;
+
+        int nextIdx = NO_CHILD;
+        PlayerAction nextAction = PlayerAction::ball;
+        for (auto playerAction : { PlayerAction::ball, PlayerAction::bait, PlayerAction::rock })
+        {
+          int childIdx = node.children[playerAction];
+          if (childIdx == NO_CHILD)
+            continue;
+
+          if (nextIdx != NO_CHILD)
+          {
+            StateDistribution childDistribution = distribution;
+            childDistribution.ApplyAction(playerAction);
+            pending.push_back({ childIdx, std::move(childDistribution) });
+            continue;
+          }
+          nextIdx = childIdx;
+          nextAction = playerAction;
+        }
+
+        if (nextIdx == NO_CHILD)
+          break;
+        distribution.ApplyAction(nextAction);
+        nodeIdx = nextIdx;
+      }
+    }
+  }
+};
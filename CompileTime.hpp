@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+
+#include "Types.hpp"
+#include "Constants.hpp"
+#include "State.hpp"
+
+/*
+Catch probability computed by the compiler, for a species and actionByTurn known at compile time.
+Nothing is computed when the program runs, and known results can be checked with static_assert.
+
+Ex: CompileTimeCatchProb<30, 125, PlayerAction::bait, PlayerAction::ball>::value
+
+Same algorithm as StateDistribution, with double precision, using the constexpr tables of Constants.hpp.
+Each action of the sequence is one unrolled call to ApplyAction.
+Long sequences may require raising the compiler constexpr limit (/constexpr:steps for MSVC, -fconstexpr-ops-limit for GCC).
+*/
+struct CompileTimeDistribution
+{
+  /* Max number of distinct states in a turn. See TransitionTable for the number of reachable states. */
+  static constexpr int MAX_STATE_COUNT = 128;
+  /* Number of distinct (safariCatchFactor, safariBaitThrowCounter, safariRockThrowCounter). Catch factor is at most 20, counters at most 6. */
+  static constexpr int SLOT_COUNT = 21 * 7 * 7;
+
+  struct Entry
+  {
+    State state = State(0, 0);
+    double prob = 0;
+  };
+
+  std::array<Entry, MAX_STATE_COUNT> entries{};
+  int entryCount = 0;
+  double caughtProb = 0;
+
+  constexpr CompileTimeDistribution(const State& initialState)
+  {
+    this->entries[0] = Entry{ initialState, 1 };
+    this->entryCount = 1;
+  }
+
+  constexpr void ApplyAction(PlayerAction playerAction)
+  {
+    std::array<Entry, MAX_STATE_COUNT> next{};
+    int nextCount = 0;
+    // entryIdxBySlot[slot] - 1: index in next, 0 if the state was not reached yet
+    std::array<int, SLOT_COUNT> entryIdxBySlot{};
+
+    auto AddState = [&](const State& state, double prob)
+    {
+      int slot = (state.safariCatchFactor * 7 + state.safariBaitThrowCounter) * 7 + state.safariRockThrowCounter;
+      if (entryIdxBySlot[slot] == 0)
+      {
+        next[nextCount++] = Entry{ state, 0 };
+        entryIdxBySlot[slot] = nextCount;
+      }
+      next[entryIdxBySlot[slot] - 1].prob += prob;
+    };
+
+    for (int i = 0; i < this->entryCount; i++)
+    {
+      const Entry& entry = this->entries[i];
+      double stayProb = (65536 - FleeCountBySafariFleeRate[entry.state.GetSafariFleeRate()]) / 65536.;
+
+      if (playerAction == PlayerAction::ball)
+      {
+        double catchProb = GetCatchProb(entry.state.safariCatchFactor);
+        this->caughtProb += entry.prob * catchProb;
+        AddState(entry.state.ApplyActions(playerAction, 0, PokemonAction::watchCarefully), entry.prob * ((1 - catchProb) * stayProb));
+        continue;
+      }
+
+      u8 counter = playerAction == PlayerAction::bait ? entry.state.safariBaitThrowCounter : entry.state.safariRockThrowCounter;
+      State::ForEachCounterValue(counter, [&](u8 counterAfter, u32 count)
+        {
+          AddState(entry.state.ApplyActions(playerAction, counterAfter, PokemonAction::watchCarefully), entry.prob * (count / 65536. * stayProb));
+        });
+    }
+
+    this->entries = next;
+    this->entryCount = nextCount;
+  }
+
+  static constexpr double GetCatchProb(u8 safariCatchFactor)
+  {
+    u32 odds = ShakeOddsBySafariCatchFactor[safariCatchFactor];
+    double shakeProb = odds / 65536.;
+    double catchProb = 1;
+    for (int i = 0; i < 4; i++)
+      catchProb *= shakeProb;
+    return catchProb;
+  }
+};
+
+template<u8 catchRate, u8 safariZoneFleeRate, PlayerAction... actionByTurn>
+struct CompileTimeCatchProb
+{
+  static constexpr double value = ([]()
+    {
+      CompileTimeDistribution distribution(State(catchRate, safariZoneFleeRate));
+      (distribution.ApplyAction(actionByTurn), ...);
+      return distribution.caughtProb;
+    })();
+};
+
+// Known results (see README)
+static_assert(CompileTimeCatchProb<30, 125, PlayerAction::bait, PlayerAction::bait, PlayerAction::ball, PlayerAction::ball, PlayerAction::ball>::value > 0.10049
+  && CompileTimeCatchProb<30, 125, PlayerAction::bait, PlayerAction::bait, PlayerAction::ball, PlayerAction::ball, PlayerAction::ball>::value < 0.10051);
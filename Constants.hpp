@@ -1,15 +1,18 @@
 #pragma once
 
+#include <array>
+#include <vector>
+
 #include "Types.hpp"
 #include "Prob.hpp"
 
-/* 
-StayFleeProbBySafariFleeRate[SafariFleeRate] = {StayProbability, FleeProbability} 
-Ex: StayFleeProbBySafariFleeRate[45] =  {~55%, ~45%}
+/*
+FleeCountBySafariFleeRate[SafariFleeRate] = Number of RandomUint16 values (out of 65536) such as RandomUint16 % 100 < SafariFleeRate
+Ex: FleeCountBySafariFleeRate[45] = 29511 (~45%)
 */
-static const std::vector<std::pair<const Prob, const Prob>> StayFleeProbBySafariFleeRate = ([]()
+constexpr std::array<u32, 256> FleeCountBySafariFleeRate = ([]()
   {
-    std::vector<std::pair<const Prob, const Prob>> arr;
+    std::array<u32, 256> arr{};
     for (u32 safariFleeRate = 0; safariFleeRate <= 255; safariFleeRate++)
     {
       // RandomUint16 % 100 is more likely to be between 0-35 then 36+
@@ -17,27 +20,37 @@ static const std::vector<std::pair<const Prob, const Prob>> StayFleeProbBySafari
       u32 count_at36AndAbove = 655;   // there are 655 possible Uint16 values such as Uint16 % 100 == 36
 
       u32 count = 0;
-      for (u32 i = 0; i < safariFleeRate; i++)
+      for (u32 i = 0; i < safariFleeRate && i < 100; i++) // RandomUint16 % 100 < 100 is always true
         count += i < 36 ? count_below36 : count_at36AndAbove;
 
-      arr.emplace_back(Prob(65536 - count, 65536), Prob(count, 65536));
+      arr[safariFleeRate] = count;
     }
   return arr;
   })();
 
-
 /*
-CatchMissProbBySafariCatchFactor[SafariCatchFactor] = {CatchProbability, MissProbability}
-Ex: CatchMissProbBySafariCatchFactor[3] =  {~8%, ~92%}
+ShakeOddsBySafariCatchFactor[SafariCatchFactor] = Number of RandomUint16 values (out of 65536) such as one ball shake succeeds.
+The pokemon is caught if 4 shakes in a row succeed. 65536 means the pokemon is always caught.
+Ex: ShakeOddsBySafariCatchFactor[3] = 34952 (~53% per shake, ~8% to catch)
 */
-static const std::vector<std::pair<const Prob, const Prob>> CatchMissProbBySafariCatchFactor = ([]()
+constexpr std::array<u32, 256> ShakeOddsBySafariCatchFactor = ([]()
   {
-    std::vector<std::pair<const Prob, const Prob>> arr;
+    std::array<u32, 256> arr{};
 
     auto Sqrt = [](u32 val)
     {
       // gba Sqrt truncates. See http://starflakenights.net/libraries/devkitpro-libgba/docs/html/a00019.html#a72965f900a655e3dc76d2491d415d2a4
-      return (u16)std::sqrt(val);
+      u32 low = 0;
+      u32 high = 65536;
+      while (high - low > 1) // Largest root such as root * root <= val
+      {
+        u32 mid = (low + high) / 2;
+        if ((u64)mid * mid <= val)
+          low = mid;
+        else
+          high = mid;
+      }
+      return low;
     };
 
     for (u32 safariCatchFactor = 0; safariCatchFactor <= 255; safariCatchFactor++)
@@ -47,26 +60,67 @@ static const std::vector<std::pair<const Prob, const Prob>> CatchMissProbBySafar
       u32 odds = catchRate * ballMultiplier / 30;
 
       if (odds > 254)
-      {
-        arr.emplace_back(Prob::ONE, Prob::ZERO);
-        continue;
-      }
-      if (odds == 0)
-      {
-        arr.emplace_back(Prob::ZERO, Prob::ONE);
-        continue;
-      }
-
-      odds = Sqrt(Sqrt(16711680 / odds));
-      odds = 1048560 / odds;
-
-      Prob baseProb(odds, 65536);
-      Prob res(1);
-      for (int i = 0; i < 4; i++)
-        res.Mul(baseProb);
-
-      arr.emplace_back(res, res.Complement());
+        arr[safariCatchFactor] = 65536;
+      else if (odds == 0)
+        arr[safariCatchFactor] = 0;
+      else
+        arr[safariCatchFactor] = 1048560 / Sqrt(Sqrt(16711680 / odds));
     }
   return arr;
   })();
 
+/*
+StayFleeProbBySafariFleeRate<P>()[SafariFleeRate] = {StayProbability, FleeProbability}
+Ex: StayFleeProbBySafariFleeRate<Prob>()[45] =  {~55%, ~45%}
+Built on first use, once per probability type.
+*/
+template<typename P>
+const std::vector<std::pair<const P, const P>>& StayFleeProbBySafariFleeRate()
+{
+  static const std::vector<std::pair<const P, const P>> arr = ([]()
+    {
+      std::vector<std::pair<const P, const P>> arr;
+      for (u32 count : FleeCountBySafariFleeRate)
+        arr.emplace_back(P(65536 - count, 65536), P(count, 65536));
+    return arr;
+    })();
+  return arr;
+}
+
+
+/*
+CatchMissProbBySafariCatchFactor<P>()[SafariCatchFactor] = {CatchProbability, MissProbability}
+Ex: CatchMissProbBySafariCatchFactor<Prob>()[3] =  {~8%, ~92%}
+Built on first use, once per probability type.
+*/
+template<typename P>
+const std::vector<std::pair<const P, const P>>& CatchMissProbBySafariCatchFactor()
+{
+  static const std::vector<std::pair<const P, const P>> arr = ([]()
+    {
+      std::vector<std::pair<const P, const P>> arr;
+
+      for (u32 odds : ShakeOddsBySafariCatchFactor)
+      {
+        if (odds == 65536)
+        {
+          arr.emplace_back(P::ONE, P::ZERO);
+          continue;
+        }
+        if (odds == 0)
+        {
+          arr.emplace_back(P::ZERO, P::ONE);
+          continue;
+        }
+
+        P baseProb(odds, 65536);
+        P res(1);
+        for (int i = 0; i < 4; i++)
+          res.Mul(baseProb);
+
+        arr.emplace_back(res, res.Complement());
+      }
+    return arr;
+    })();
+  return arr;
+}
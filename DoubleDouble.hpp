@@ -0,0 +1,135 @@
+#pragma once
+
+#include <string>
+#include <cmath>
+
+/*
+Number represented as the unevaluated sum hi + lo of two doubles, with |lo| <= ulp(hi) / 2.
+
+Gives ~106 bits of relative precision: unlike R128 (fixed point), tiny probabilities deep in the Node graph keep all their significant bits.
+Operations only use double additions and multiplications (error-free transformations), so it is a few times slower than double.
+See Dekker 1971, "A floating-point technique for extending the available precision".
+*/
+struct DoubleDouble
+{
+  double hi = 0;
+  double lo = 0;
+
+  DoubleDouble() {}
+
+  DoubleDouble(double val) : hi(val) {}
+
+  DoubleDouble(int val) : hi(val) {}
+
+  DoubleDouble& operator+=(const DoubleDouble& toAdd)
+  {
+    double err;
+    double sum = TwoSum(this->hi, toAdd.hi, err);
+    err += this->lo + toAdd.lo;
+    this->hi = QuickTwoSum(sum, err, this->lo);
+    return *this;
+  }
+
+  DoubleDouble operator-(const DoubleDouble& toSub) const
+  {
+    DoubleDouble res = *this;
+    res += DoubleDouble::FromParts(-toSub.hi, -toSub.lo);
+    return res;
+  }
+
+  DoubleDouble& operator*=(const DoubleDouble& factor)
+  {
+    double err;
+    double product = TwoProd(this->hi, factor.hi, err);
+    err += this->hi * factor.lo + this->lo * factor.hi;
+    this->hi = QuickTwoSum(product, err, this->lo);
+    return *this;
+  }
+
+  DoubleDouble& operator/=(const DoubleDouble& denom)
+  {
+    // One Newton step on the quotient of the high parts
+    double quotient = this->hi / denom.hi;
+    DoubleDouble remainder = *this - DoubleDouble(quotient) * denom;
+    double correction = remainder.hi / denom.hi;
+    this->hi = QuickTwoSum(quotient, correction, this->lo);
+    return *this;
+  }
+
+  friend DoubleDouble operator*(DoubleDouble lhs, const DoubleDouble& rhs)
+  {
+    lhs *= rhs;
+    return lhs;
+  }
+
+  explicit operator double() const
+  {
+    return this->hi + this->lo;
+  }
+
+  /* Decimal representation with <digitCount> digits after the decimal point. Only meant for values in [0, 1]. */
+  std::string ToStr(int digitCount = 30) const
+  {
+    DoubleDouble rest = *this;
+    double integer = std::floor(rest.hi);
+    rest += DoubleDouble(-integer);
+
+    std::string str = std::to_string((long long)integer) + ".";
+    for (int i = 0; i < digitCount; i++)
+    {
+      rest *= DoubleDouble(10);
+      double digit = std::floor(rest.hi);
+      if (rest.hi == digit && rest.lo < 0) // Ex: 3 - 1e-20 is a 2
+        digit--;
+      rest += DoubleDouble(-digit);
+      str += (char)('0' + (int)digit);
+    }
+    return str;
+  }
+
+private:
+  static DoubleDouble FromParts(double hi, double lo)
+  {
+    DoubleDouble res;
+    res.hi = hi;
+    res.lo = lo;
+    return res;
+  }
+
+  /* a + b = sum + err exactly */
+  static double TwoSum(double a, double b, double& err)
+  {
+    double sum = a + b;
+    double bVirtual = sum - a;
+    err = (a - (sum - bVirtual)) + (b - bVirtual);
+    return sum;
+  }
+
+  /* Same as TwoSum, requires |a| >= |b| */
+  static double QuickTwoSum(double a, double b, double& err)
+  {
+    double sum = a + b;
+    err = b - (sum - a);
+    return sum;
+  }
+
+  /* a * b = product + err exactly.
+     std::fma would be shorter, but without FMA instructions enabled (default for x64 MSVC and GCC), it is a slow library call. */
+  static double TwoProd(double a, double b, double& err)
+  {
+    double product = a * b;
+    double aHi, aLo, bHi, bLo;
+    Split(a, aHi, aLo);
+    Split(b, bHi, bLo);
+    err = ((aHi * bHi - product) + aHi * bLo + aLo * bHi) + aLo * bLo;
+    return product;
+  }
+
+  /* a = hi + lo, where hi and lo have at most 26 significant bits, so their products are exact */
+  static void Split(double a, double& hi, double& lo)
+  {
+    double temp = 134217729.0 * a; // 2^27 + 1
+    hi = temp - (temp - a);
+    lo = a - hi;
+  }
+};
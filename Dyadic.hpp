@@ -0,0 +1,252 @@
+#pragma once
+
+#include <string>
+#include <cmath>
+#include <cassert>
+
+#include "Types.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+Exact fixed point number: value = limbs (as one big unsigned integer) / 2^(64 * FRACTION_LIMB_COUNT).
+
+Every probability of the game is a fraction whose denominator is a power of two (65536 for flee and bait/rock counters,
+65536^4 for catch), so products and sums of them are exactly representable as long as there are enough fraction limbs.
+Each ball turn needs ~80 bits (64 for the catch, 16 for the flee), each bait/rock turn ~32 bits.
+Ex: The optimal setup for Chansey (30 balls, 13 baits) needs ~2800 bits, so Dyadic<64> (4096 bits) is exact.
+
+If a result needs more bits than available, the lowest bits are dropped and exact becomes false.
+
+No dynamic allocation: numbers are fixed size, so they can be copied around like double.
+*/
+template<int FRACTION_LIMB_COUNT>
+struct Dyadic
+{
+  /* One more limb for the integer part (1 for Prob::ONE) */
+  static constexpr int LIMB_COUNT = FRACTION_LIMB_COUNT + 1;
+
+  /* limbs[0] is the least significant */
+  u64 limbs[LIMB_COUNT] = {};
+  /* False if bits were dropped by an operation that needed more than FRACTION_LIMB_COUNT limbs */
+  bool exact = true;
+
+  Dyadic() {}
+
+  Dyadic(int val) : Dyadic((double)val) {}
+
+  /* Every non-negative double is a dyadic number, so the conversion is exact unless val < 2^-(64 * FRACTION_LIMB_COUNT) */
+  Dyadic(double val)
+  {
+    assert(val >= 0 && val < 18446744073709551616.);
+    if (val == 0)
+      return;
+
+    int exponent;
+    double mantissa = std::frexp(val, &exponent); // val = mantissa * 2^exponent, mantissa in [0.5, 1)
+    this->limbs[0] = (u64)std::ldexp(mantissa, 64);
+    ShiftLeft(exponent - 64 + 64 * FRACTION_LIMB_COUNT);
+  }
+
+  Dyadic& operator+=(const Dyadic& toAdd)
+  {
+    u64 carry = 0;
+    for (int i = 0; i < LIMB_COUNT; i++)
+    {
+      u64 sum = this->limbs[i] + carry;
+      carry = sum < carry;
+      sum += toAdd.limbs[i];
+      carry += sum < toAdd.limbs[i];
+      this->limbs[i] = sum;
+    }
+    this->exact = this->exact && toAdd.exact;
+    return *this;
+  }
+
+  /* Only used for complements (1 - prob), so the result is never negative */
+  Dyadic operator-(const Dyadic& toSub) const
+  {
+    Dyadic res = *this;
+    u64 borrow = 0;
+    for (int i = 0; i < LIMB_COUNT; i++)
+    {
+      u64 diff = res.limbs[i] - toSub.limbs[i];
+      u64 nextBorrow = res.limbs[i] < toSub.limbs[i];
+      nextBorrow += diff < borrow;
+      res.limbs[i] = diff - borrow;
+      borrow = nextBorrow;
+    }
+    res.exact = this->exact && toSub.exact;
+    return res;
+  }
+
+  Dyadic& operator*=(const Dyadic& factor)
+  {
+    u64 product[2 * LIMB_COUNT] = {};
+
+    // Probabilities only use a few limbs (Ex: a flee probability is 16 bits), so zero limbs are skipped
+    int begin = this->GetLowestNonZeroLimb();
+    int end = this->GetHighestNonZeroLimb() + 1;
+
+    for (int j = 0; j < LIMB_COUNT; j++)
+    {
+      if (factor.limbs[j] == 0)
+        continue;
+
+      u64 carry = 0;
+      for (int i = begin; i < end; i++)
+        product[i + j] = MulAdd(this->limbs[i], factor.limbs[j], product[i + j], carry, carry);
+      for (int k = end + j; carry != 0 && k < 2 * LIMB_COUNT; k++)
+      {
+        product[k] += carry;
+        carry = product[k] < carry;
+      }
+    }
+
+    // product has 2 * FRACTION_LIMB_COUNT fraction limbs, only the highest FRACTION_LIMB_COUNT are kept
+    bool exact = this->exact && factor.exact;
+    for (int i = 0; i < FRACTION_LIMB_COUNT; i++)
+      exact = exact && product[i] == 0;
+
+    for (int i = 0; i < LIMB_COUNT; i++)
+      this->limbs[i] = product[i + FRACTION_LIMB_COUNT];
+    this->exact = exact;
+    return *this;
+  }
+
+  /* Only supports powers of two, which are the only denominators of the game */
+  Dyadic& operator/=(const Dyadic& denom)
+  {
+    int highest = denom.GetHighestNonZeroLimb();
+    assert(highest >= 0 && (denom.limbs[highest] & (denom.limbs[highest] - 1)) == 0);
+
+    int bitIdx = highest * 64;
+    for (u64 limb = denom.limbs[highest]; limb > 1; limb >>= 1)
+      bitIdx++;
+
+    int shift = bitIdx - 64 * FRACTION_LIMB_COUNT; // denom = 2^shift
+    if (shift > 0)
+      ShiftRight(shift);
+    else
+      ShiftLeft(-shift);
+    return *this;
+  }
+
+  explicit operator double() const
+  {
+    // The 2 highest non-zero limbs hold at least 65 significant bits, more than the 53 bits of double
+    double res = 0;
+    int highest = this->GetHighestNonZeroLimb();
+    for (int i = highest; i >= 0 && i >= highest - 1; i--)
+      res += std::ldexp((double)this->limbs[i], 64 * (i - FRACTION_LIMB_COUNT));
+    return res;
+  }
+
+  /* Exact decimal representation, truncated to maxDigitCount digits after the decimal point.
+     Ex: "0.1899124776356253..." */
+  std::string ToStr(int maxDigitCount = 40) const
+  {
+    std::string str = std::to_string(this->limbs[FRACTION_LIMB_COUNT]) + ".";
+
+    // Multiplying the fraction by 10 moves the next digit to the integer part
+    Dyadic fraction = *this;
+    fraction.limbs[FRACTION_LIMB_COUNT] = 0;
+    int digitCount = 0;
+    do
+    {
+      u64 carry = 0;
+      for (int i = 0; i < LIMB_COUNT; i++)
+        fraction.limbs[i] = MulAdd(fraction.limbs[i], 10, 0, carry, carry);
+      str += (char)('0' + fraction.limbs[FRACTION_LIMB_COUNT]);
+      fraction.limbs[FRACTION_LIMB_COUNT] = 0;
+      digitCount++;
+    } while (!fraction.IsZero() && digitCount < maxDigitCount);
+
+    if (!fraction.IsZero())
+      str += "...";
+    if (!this->exact)
+      str += " (inexact, increase FRACTION_LIMB_COUNT)";
+    return str;
+  }
+
+  bool IsZero() const
+  {
+    return GetHighestNonZeroLimb() < 0;
+  }
+
+private:
+  /* Returns low 64 bits of a * b + add1 + add2. high receives the high 64 bits. It can't overflow: (2^64-1)^2 + 2 * (2^64-1) < 2^128 */
+  static u64 MulAdd(u64 a, u64 b, u64 add1, u64 add2, u64& high)
+  {
+#if defined(_MSC_VER)
+    u64 productHigh;
+    u64 low = _umul128(a, b, &productHigh);
+    low += add1;
+    productHigh += low < add1;
+    low += add2;
+    productHigh += low < add2;
+    high = productHigh;
+    return low;
+#else
+    unsigned __int128 res = (unsigned __int128)a * b + add1 + add2;
+    high = (u64)(res >> 64);
+    return (u64)res;
+#endif
+  }
+
+  int GetLowestNonZeroLimb() const
+  {
+    for (int i = 0; i < LIMB_COUNT; i++)
+      if (this->limbs[i] != 0)
+        return i;
+    return LIMB_COUNT;
+  }
+
+  int GetHighestNonZeroLimb() const
+  {
+    for (int i = LIMB_COUNT - 1; i >= 0; i--)
+      if (this->limbs[i] != 0)
+        return i;
+    return -1;
+  }
+
+  void ShiftLeft(int bitCount)
+  {
+    if (bitCount < 0)
+      return ShiftRight(-bitCount);
+
+    int limbShift = bitCount / 64;
+    int bitShift = bitCount % 64;
+    for (int i = LIMB_COUNT - 1; i >= 0; i--)
+    {
+      u64 val = i - limbShift >= 0 ? this->limbs[i - limbShift] << bitShift : 0;
+      if (bitShift != 0 && i - limbShift - 1 >= 0)
+        val |= this->limbs[i - limbShift - 1] >> (64 - bitShift);
+      this->limbs[i] = val;
+    }
+  }
+
+  void ShiftRight(int bitCount)
+  {
+    int limbShift = bitCount / 64;
+    int bitShift = bitCount % 64;
+
+    // Dropped bits
+    for (int i = 0; i < LIMB_COUNT && i <= limbShift; i++)
+    {
+      u64 dropped = i < limbShift ? this->limbs[i] : this->limbs[i] & ((u64(1) << bitShift) - 1);
+      if (dropped != 0)
+        this->exact = false;
+    }
+
+    for (int i = 0; i < LIMB_COUNT; i++)
+    {
+      u64 val = i + limbShift < LIMB_COUNT ? this->limbs[i + limbShift] >> bitShift : 0;
+      if (bitShift != 0 && i + limbShift + 1 < LIMB_COUNT)
+        val |= this->limbs[i + limbShift + 1] << (64 - bitShift);
+      this->limbs[i] = val;
+    }
+  }
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+#include "Types.hpp"
+
+/*
+Interval [lo, hi] of doubles that always contains the exact value.
+
+After each operation, lo is moved one double down and hi one double up, so the rounding error of the operation
+(at most half a unit in the last place) stays inside the interval. This doesn't depend on the floating-point rounding mode,
+which most compilers ignore unless told otherwise.
+The width of the final interval is a rigorous bound of the error accumulated by double over all the operations.
+
+Only meant for probabilities: values are never negative, which keeps multiplications to 2 products instead of 4.
+*/
+struct Interval
+{
+  double lo = 0;
+  double hi = 0;
+
+  Interval() {}
+
+  Interval(double val) : lo(val), hi(val) {}
+
+  Interval(int val) : lo(val), hi(val) {}
+
+  Interval& operator+=(const Interval& toAdd)
+  {
+    this->lo = NextDown(this->lo + toAdd.lo);
+    this->hi = NextUp(this->hi + toAdd.hi);
+    return *this;
+  }
+
+  Interval operator-(const Interval& toSub) const
+  {
+    Interval res;
+    res.lo = NextDown(this->lo - toSub.hi);
+    res.hi = NextUp(this->hi - toSub.lo);
+    return res;
+  }
+
+  Interval& operator*=(const Interval& factor)
+  {
+    this->lo = NextDown(this->lo * factor.lo);
+    this->hi = NextUp(this->hi * factor.hi);
+    return *this;
+  }
+
+  Interval& operator/=(const Interval& denom)
+  {
+    this->lo = NextDown(this->lo / denom.hi);
+    this->hi = NextUp(this->hi / denom.lo);
+    return *this;
+  }
+
+  explicit operator double() const
+  {
+    return GetMid();
+  }
+
+  double GetMid() const
+  {
+    return this->lo + (this->hi - this->lo) / 2;
+  }
+
+  /* Max distance between GetMid() and the exact value */
+  double GetError() const
+  {
+    return NextUp((this->hi - this->lo) / 2);
+  }
+
+  /* Ex: "0.189912 +/- 3e-15". Not the ± symbol, which most Windows consoles don't display.
+     The error is rounded up to one digit, so the printed bound stays rigorous. */
+  std::string ToStr() const
+  {
+    double error = GetError();
+    double power = std::pow(10, std::floor(std::log10(error)));
+    char errorStr[32];
+    if (error == 0 || power == 0) // power underflows to 0 for subnormal errors. Ex: 0 +/- 5e-324 when nothing can catch the pokemon
+      snprintf(errorStr, sizeof(errorStr), "%.0e", error);
+    else
+      snprintf(errorStr, sizeof(errorStr), "%.0e", std::ceil(error / power) * power);
+    return std::to_string(GetMid()) + " +/- " + errorStr;
+  }
+
+private:
+  /* Smallest double > val */
+  static double NextUp(double val)
+  {
+    u64 bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    bits = val == 0 ? 1 : val > 0 ? bits + 1 : bits - 1; // Sign and magnitude: the magnitude of negative values decreases
+    std::memcpy(&val, &bits, sizeof(bits));
+    return val;
+  }
+
+  /* Largest double < val, but never below 0: a probability can't be negative. */
+  static double NextDown(double val)
+  {
+    if (val <= 0)
+      return 0;
+    u64 bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    bits--;
+    std::memcpy(&val, &bits, sizeof(bits));
+    return val;
+  }
+};
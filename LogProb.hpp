@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+/*
+Probability stored as its natural logarithm. Ex: 1e-400 is stored as -921.03
+
+double can't go below ~1e-308 (and R128 below 2^-64 ~ 5e-20): for sequences of hundreds of turns, the probability of
+a deep branch becomes exactly 0. Its logarithm is still a small number, so no branch is lost.
+Multiplications are additions of logarithms (exact range, no underflow). Additions use log-sum-exp, so they are slower than double.
+*/
+struct LogProb
+{
+  /* ln(probability). -infinity for 0 */
+  double log = -std::numeric_limits<double>::infinity();
+
+  LogProb() {}
+
+  LogProb(double val) : log(std::log(val)) {}
+
+  LogProb(int val) : log(std::log((double)val)) {}
+
+  /* ln(a + b) = max + ln(1 + e^(min - max)), which never overflows */
+  LogProb& operator+=(const LogProb& toAdd)
+  {
+    double max = std::max(this->log, toAdd.log);
+    double min = std::min(this->log, toAdd.log);
+    if (min == -std::numeric_limits<double>::infinity())
+      this->log = max;
+    else
+      this->log = max + std::log1p(std::exp(min - max));
+    return *this;
+  }
+
+  /* Only used for complements (1 - prob): ln(1 - e^b), with a >= b */
+  LogProb operator-(const LogProb& toSub) const
+  {
+    LogProb res;
+    if (toSub.log == -std::numeric_limits<double>::infinity())
+      return *this;
+    res.log = this->log + std::log1p(-std::exp(toSub.log - this->log));
+    return res;
+  }
+
+  LogProb& operator*=(const LogProb& factor)
+  {
+    this->log += factor.log;
+    return *this;
+  }
+
+  LogProb& operator/=(const LogProb& denom)
+  {
+    this->log -= denom.log;
+    return *this;
+  }
+
+  /* 0 if the probability is below ~1e-308 */
+  explicit operator double() const
+  {
+    return std::exp(this->log);
+  }
+
+  /* Works below the range of double. Ex: "1.234567e-400" */
+  std::string ToStr() const
+  {
+    if (this->log == -std::numeric_limits<double>::infinity())
+      return std::to_string(0.);
+
+    double log10 = this->log / std::log(10.);
+    double exponent = std::floor(log10);
+    if (exponent >= -4) // Same format as double
+      return std::to_string((double)*this);
+
+    double mantissa = std::pow(10, log10 - exponent);
+    if (mantissa >= 9.9999995) // pow, or %f with 6 decimals, can round up to 10. Ex: 10.000000e-649 instead of 1.000000e-648
+    {
+      mantissa /= 10;
+      exponent++;
+    }
+
+    char str[64];
+    snprintf(str, sizeof(str), "%fe%d", mantissa, (int)exponent);
+    return str;
+  }
+};
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "Types.hpp"
+#include "Constants.hpp"
+#include "State.hpp"
+#include "ThreadPool.hpp"
+
+/*
+Random number generator where the n-th value of a stream is a hash of (stream key, n): no state to share between threads,
+and any block of trials can be replayed on its own. Each 64-bits hash gives four RandomUint16.
+The hash is the SplitMix64 finalizer. See Salmon et al. 2011, "Parallel random numbers: as easy as 1, 2, 3".
+*/
+struct CounterRng
+{
+  CounterRng(u64 seed, u64 streamIdx) :
+    key(Hash(seed ^ Hash(streamIdx)))
+  {}
+
+  u16 RandomUint16()
+  {
+    if (this->bufferedCount == 0)
+    {
+      this->buffered = Hash(this->key + this->counter++);
+      this->bufferedCount = 4;
+    }
+    u16 val = (u16)this->buffered;
+    this->buffered >>= 16;
+    this->bufferedCount--;
+    return val;
+  }
+
+private:
+  u64 key;
+  u64 counter = 0;
+  u64 buffered = 0;
+  int bufferedCount = 0;
+
+  static u64 Hash(u64 x)
+  {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+  }
+};
+
+/*
+Estimates the catch probability by simulating random battles, like montecarlo.js. Used to cross-check the exact engines.
+
+Battles are simulated with State and the draws of the game, not with TransitionTable: the simulation stays an independent
+check of the table that the exact engines use, and the battles draw RandomUint16 like montecarlo.js.
+Same rules as the exact engines: the battle ends when actionByTurn is over. To keep throwing balls like montecarlo.js, pad actionByTurn with ApplyBallCount.
+Each turn draws RandomUint16 in the same order as the game: flee check, then the player action.
+
+With reduceVariance, each battle estimates its catch probability instead of returning caught or not caught:
+  - Conditional expectation: ball and flee results are not drawn. The battle adds P(reach this ball) * P(catch) to its
+    estimate, then continues with P(reach next turn) *= P(miss) * P(stay). Only the bait/rock results are left to chance.
+  - Stratification: a block of BLOCK_TRIAL_COUNT = 5^5 battles contains every combination of the first 5 bait/rock results
+    (RandomUint16 % 5) exactly once, weighted by their probability, so the luck of these draws cancels out inside the block.
+Ex: For Chansey optimal setup, 800K battles give +/- 3e-6, where 59M battles without it give +/- 1e-4.
+
+Trials are grouped in blocks, each with its own CounterRng stream (seed, blockIdx), and blocks are run ROUND_BLOCK_COUNT
+at a time on every thread. The confidence interval is computed from the block means and only checked between rounds,
+so for a given seed, the result is identical for any number of threads.
+*/
+struct MonteCarlo
+{
+  /* Number of bait/rock results covered by each block with reduceVariance */
+  static constexpr int STRATIFIED_DRAW_COUNT = 5;
+  static constexpr u64 BLOCK_TRIAL_COUNT = 3125; // 5^STRATIFIED_DRAW_COUNT
+  static constexpr u64 ROUND_BLOCK_COUNT = 256;
+
+  struct Result
+  {
+    u64 trialCount = 0;
+    double catchProb = 0;
+    /* Half width of the 95% confidence interval of catchProb */
+    double halfWidth = 1;
+  };
+
+  MonteCarlo(const std::vector<PlayerAction>& actionByTurn, u64 seed, bool reduceVariance, const State& initialState = State()) :
+    actionByTurn(actionByTurn),
+    seed(seed),
+    reduceVariance(reduceVariance),
+    initialState(initialState)
+  {}
+
+  /* Runs trials until the 95% confidence interval half width is at most maxHalfWidth, or maxTrialCount trials were run. */
+  Result Run(ThreadPool& threadPool, u64 maxTrialCount, double maxHalfWidth) const
+  {
+    static constexpr double Z_95 = 1.959964;
+
+    Result result;
+    std::vector<double> meanByBlock(ROUND_BLOCK_COUNT);
+    u64 blockCount = 0;
+    double sum = 0;
+    double sumOfSquares = 0;
+
+    while (result.trialCount < maxTrialCount && result.halfWidth > maxHalfWidth)
+    {
+      threadPool.ParallelFor(ROUND_BLOCK_COUNT, [&](size_t i)
+        {
+          meanByBlock[i] = RunBlock(blockCount + i);
+        });
+      blockCount += ROUND_BLOCK_COUNT;
+      result.trialCount += ROUND_BLOCK_COUNT * BLOCK_TRIAL_COUNT;
+
+      for (double mean : meanByBlock)
+      {
+        sum += mean;
+        sumOfSquares += mean * mean;
+      }
+
+      // Block means are independent samples of the catch probability
+      result.catchProb = sum / blockCount;
+      double variance = std::max(0., (sumOfSquares - sum * result.catchProb) / (blockCount - 1));
+      result.halfWidth = Z_95 * std::sqrt(variance / blockCount);
+    }
+    return result;
+  }
+
+private:
+  std::vector<PlayerAction> actionByTurn;
+  u64 seed;
+  bool reduceVariance;
+  State initialState;
+
+  /* Returns the mean catch probability of the trials of the block */
+  double RunBlock(u64 blockIdx) const
+  {
+    CounterRng rng(this->seed, blockIdx);
+    double sum = 0;
+    for (u64 i = 0; i < BLOCK_TRIAL_COUNT; i++)
+      sum += this->reduceVariance ? RunTrialWithReducedVariance(rng, i) : RunTrial(rng);
+    return sum / BLOCK_TRIAL_COUNT;
+  }
+
+  bool RunTrial(CounterRng& rng) const
+  {
+    State state = this->initialState;
+
+    for (auto playerAction : this->actionByTurn)
+    {
+      // The flee check uses the state before the player action
+      bool willFlee = rng.RandomUint16() % 100 < state.GetSafariFleeRate();
+
+      u8 playerActionValue = 0;
+      if (playerAction == PlayerAction::ball)
+      {
+        u32 odds = ShakeOddsBySafariCatchFactor[state.safariCatchFactor];
+        int shakeCount = 0;
+        while (shakeCount < 4 && rng.RandomUint16() < odds)
+          shakeCount++;
+        if (shakeCount == 4)
+          return true;
+      }
+      else
+        playerActionValue = GetCounterAfter(state, playerAction, rng.RandomUint16() % 5);
+
+      if (willFlee)
+        return false;
+
+      state = state.ApplyActions(playerAction, playerActionValue, PokemonAction::watchCarefully);
+    }
+    return false;
+  }
+
+  /* Returns the catch probability of the battle, given the bait/rock results. <trialIdx> (index in the block) selects the
+     first STRATIFIED_DRAW_COUNT bait/rock results: its digits in base 5. */
+  double RunTrialWithReducedVariance(CounterRng& rng, u64 trialIdx) const
+  {
+    using DoubleProb = BasicProb<double>;
+    const auto& stayFleeProbs = StayFleeProbBySafariFleeRate<DoubleProb>();
+    const auto& catchMissProbs = CatchMissProbBySafariCatchFactor<DoubleProb>();
+
+    State state = this->initialState;
+    double reachProb = 1; // Probability that the battle is still ongoing, given the bait/rock results so far
+    double caughtProb = 0;
+    int drawCount = 0;
+
+    for (auto playerAction : this->actionByTurn)
+    {
+      double stayProb = stayFleeProbs[state.GetSafariFleeRate()].first.val;
+
+      u8 playerActionValue = 0;
+      if (playerAction == PlayerAction::ball)
+      {
+        const auto& [catchProb, missProb] = catchMissProbs[state.safariCatchFactor];
+        caughtProb += reachProb * catchProb.val;
+        reachProb *= missProb.val * stayProb;
+      }
+      else
+      {
+        u32 mod5;
+        if (drawCount < STRATIFIED_DRAW_COUNT)
+        {
+          mod5 = trialIdx % 5;
+          trialIdx /= 5;
+          // Each mod5 is used by 1/5 of the block, but RandomUint16 % 5 is more likely to be 0 than 1,2,3,4
+          reachProb *= (mod5 == 0 ? 13108 : 13107) * 5 / 65536.;
+        }
+        else
+          mod5 = rng.RandomUint16() % 5;
+        drawCount++;
+
+        playerActionValue = GetCounterAfter(state, playerAction, mod5);
+        reachProb *= stayProb;
+      }
+
+      if (reachProb == 0)
+        break;
+
+      state = state.ApplyActions(playerAction, playerActionValue, PokemonAction::watchCarefully);
+    }
+    return caughtProb;
+  }
+
+  static u8 GetCounterAfter(const State& state, PlayerAction playerAction, u32 mod5)
+  {
+    u8 counter = playerAction == PlayerAction::bait ? state.safariBaitThrowCounter : state.safariRockThrowCounter;
+    return State::GetCounterAfter(counter, mod5);
+  }
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include "Types.hpp"
+#include "Prob.hpp"
+#include "State.hpp"
+#include "TransitionTable.hpp"
+#include "StateDistribution.hpp"
+
+/*
+Finds the actionByTurn with the best catch probability, given a max number of balls and turns.
+
+General idea:
+  Depth-first search over action prefixes. Each prefix keeps its StateDistribution, so a child prefix only costs one
+  StateDistribution::ApplyAction, and all sequences sharing a prefix share its work.
+
+  Prefixes are pruned with an upper bound: the best catch probability a player could get if they could see
+  the bait/rock counters and adapt their actions (GetBestAdaptiveCatchProb). No fixed actionByTurn can do better.
+*/
+struct OptimalSearch
+{
+  struct Result
+  {
+    std::vector<PlayerAction> actionByTurn;
+    Prob catchProb = Prob::ZERO;
+  };
+
+  OptimalSearch(int ballCount, int maxTurnCount, const State& initialState = State()) :
+    ballCount(ballCount),
+    maxTurnCount(maxTurnCount),
+    table(initialState)
+  {
+  }
+
+  Result Run()
+  {
+    this->best = Result();
+    this->prefix.clear();
+    this->exploredPrefixCount = 0;
+
+    StateDistribution root(this->table);
+    Explore(root, this->ballCount, this->maxTurnCount);
+    return this->best;
+  }
+
+  size_t GetExploredPrefixCount() const
+  {
+    return this->exploredPrefixCount;
+  }
+
+private:
+  int ballCount;
+  int maxTurnCount;
+  TransitionTable table;
+
+  Result best;
+  std::vector<PlayerAction> prefix;
+  size_t exploredPrefixCount = 0;
+
+  /* Key: stateIdx, ball left, turn left */
+  std::unordered_map<u64, double> bestAdaptiveCatchProbCache;
+
+  void Explore(const StateDistribution& distribution, int ballLeft, int turnLeft)
+  {
+    this->exploredPrefixCount++;
+
+    // Actions after the last ball can't catch the pokemon, so only prefixes ending with a ball are candidates
+    if (!this->prefix.empty() && this->prefix.back() == PlayerAction::ball && distribution.caughtProb.ToFloat() > this->best.catchProb.ToFloat())
+    {
+      this->best.actionByTurn = this->prefix;
+      this->best.catchProb = distribution.caughtProb;
+    }
+
+    if (ballLeft == 0 || turnLeft == 0)
+      return;
+
+    struct Child
+    {
+      PlayerAction playerAction;
+      StateDistribution distribution;
+      double upperBound;
+    };
+
+    std::vector<Child> children;
+    for (auto playerAction : { PlayerAction::ball, PlayerAction::bait, PlayerAction::rock })
+    {
+      // A bait/rock must be followed by a ball to be useful
+      if (playerAction != PlayerAction::ball && turnLeft < 2)
+        continue;
+
+      Child child{ playerAction, distribution, 0 };
+      child.distribution.ApplyAction(playerAction);
+
+      int childBallLeft = ballLeft - (playerAction == PlayerAction::ball ? 1 : 0);
+      child.upperBound = GetUpperBound(child.distribution, childBallLeft, turnLeft - 1);
+      children.push_back(std::move(child));
+    }
+
+    // Exploring the most promising child first finds a good candidate early, which prunes more prefixes
+    std::sort(children.begin(), children.end(), [](const Child& a, const Child& b) { return a.upperBound > b.upperBound; });
+
+    for (const auto& child : children)
+    {
+      if (child.upperBound <= this->best.catchProb.ToFloat())
+        continue;
+
+      this->prefix.push_back(child.playerAction);
+      Explore(child.distribution, ballLeft - (child.playerAction == PlayerAction::ball ? 1 : 0), turnLeft - 1);
+      this->prefix.pop_back();
+    }
+  }
+
+  double GetUpperBound(const StateDistribution& distribution, int ballLeft, int turnLeft)
+  {
+    double bound = distribution.caughtProb.ToFloat();
+    for (const auto& entry : distribution.entries)
+      bound += entry.prob.ToFloat() * GetBestAdaptiveCatchProb(entry.stateIdx, ballLeft, turnLeft);
+    return bound;
+  }
+
+  /* Best catch probability from <stateIdx> if the player could choose each action after seeing the bait/rock counters. */
+  double GetBestAdaptiveCatchProb(u16 stateIdx, int ballLeft, int turnLeft)
+  {
+    if (ballLeft == 0 || turnLeft == 0)
+      return 0;
+
+    u64 key = (u64)stateIdx << 32 | (u64)ballLeft << 16 | (u64)turnLeft;
+    auto it = this->bestAdaptiveCatchProbCache.find(key);
+    if (it != this->bestAdaptiveCatchProbCache.end())
+      return it->second;
+
+    double bestProb = 0;
+
+    for (auto playerAction : { PlayerAction::ball, PlayerAction::bait, PlayerAction::rock })
+    {
+      double prob = 0;
+      int childBallLeft = ballLeft - (playerAction == PlayerAction::ball ? 1 : 0);
+
+      auto end = this->table.EndOutcomes(stateIdx, playerAction);
+      for (auto outcome = this->table.BeginOutcomes(stateIdx, playerAction); outcome != end; outcome++)
+      {
+        if (outcome->pokemonAction == PokemonAction::caught)
+          prob += outcome->prob.ToFloat();
+        else if (outcome->pokemonAction == PokemonAction::watchCarefully)
+          prob += outcome->prob.ToFloat() * GetBestAdaptiveCatchProb(outcome->nextStateIdx, childBallLeft, turnLeft - 1);
+      }
+
+      bestProb = std::max(bestProb, prob);
+    }
+
+    this->bestAdaptiveCatchProbCache[key] = bestProb;
+    return bestProb;
+  }
+};
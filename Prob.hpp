@@ -2,86 +2,149 @@
 
 #include "Types.hpp"
 
+// R128.hpp is a third-party library, kept as is
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#endif
 #define R128_IMPLEMENTATION
 #include "R128.hpp"
-
-// There are two implementations for Prob: 
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+#include "Dyadic.hpp"
+#include "DoubleDouble.hpp"
+#include "Interval.hpp"
+#include "LogProb.hpp"
+
+// There are six implementations for Prob: 
 //    - double (64-bits precision, faster)
-//    - R128 (128-bits precision, slower)
-// In most cases, both implementations return very similar results.
+//    - DoubleDouble (~106 bits of relative precision, a few times slower than double)
+//    - R128 (128-bits fixed point precision, slower, loses relative precision on tiny probabilities)
+//    - Dyadic (exact, slowest). Use it with MERGE_IDENTICAL_STATES to get reference values to check the others against.
+//    - Interval (double with a rigorous error bound, ~2x slower than double). Prints the result as "0.189912 +/- 3e-15".
+//    - LogProb (logarithm of the probability, slower than double). For sequences of hundreds of turns, where probabilities of deep branches are below the range of double.
+// In most cases, all implementations return very similar results.
+// With double, main uses ADAPTIVE_PRECISION (Interval, then DoubleDouble if needed) for the catch probability. Other implementations are used as is.
 
 using ProbImplType = double;
+// using ProbImplType = DoubleDouble;
 // using ProbImplType = R128;
+// using ProbImplType = Dyadic<64>;
+// using ProbImplType = Interval;
+// using ProbImplType = LogProb;
+
+inline std::string ProbImplToStr(double val)
+{
+  return std::to_string(val);
+}
+
+inline std::string ProbImplToStr(const DoubleDouble& val)
+{
+  return val.ToStr();
+}
+
+inline std::string ProbImplToStr(const Interval& val)
+{
+  return val.ToStr();
+}
 
-struct Prob
+inline std::string ProbImplToStr(const LogProb& val)
 {
-  static const Prob ONE;
-  static const Prob ZERO;
+  return val.ToStr();
+}
 
-  ProbImplType val = 1;
+inline std::string ProbImplToStr(const R128& val)
+{
+  return std::to_string((double)val);
+}
+
+template<int FRACTION_LIMB_COUNT>
+std::string ProbImplToStr(const Dyadic<FRACTION_LIMB_COUNT>& val)
+{
+  return val.ToStr();
+}
 
-  Prob() {}
+/* Probability stored as <Impl>. Engines templated on the probability type (BasicTransitionTable, BasicStateDistribution, BasicCompactNode)
+   can use several implementations in the same binary. Ex: Interval first, then DoubleDouble if the error bound is too big. */
+template<typename Impl>
+struct BasicProb
+{
+  static const BasicProb ONE;
+  static const BasicProb ZERO;
 
-  Prob(double val)
+  Impl val = 1;
+
+  BasicProb() {}
+
+  BasicProb(double val)
   {
     this->val = val;
   }
 
   /* Represents a fraction (num / denom) */
-  Prob(double num, double denom)
+  BasicProb(double num, double denom)
   {
-    this->val = num / denom;
+    this->val = Impl(num);
+    this->val /= Impl(denom);
   }
 
-  Prob Complement() const
+  BasicProb Complement() const
   {
-    return Prob(ProbImplType(1) - this->val);
+    BasicProb complement;
+    complement.val = Impl(1) - this->val;
+    return complement;
   }
 
   void Mul(int factor)
   {
-    this->val *= ProbImplType(factor);
+    this->val *= Impl(factor);
   }
 
-  void Mul(const Prob& factor)
+  void Mul(const BasicProb& factor)
   {
     this->val *= factor.val;
   }
-  Prob MulNew(const Prob& factor) const
+  BasicProb MulNew(const BasicProb& factor) const
   {
     auto copy = this->Clone();
     copy.Mul(factor);
     return copy;
   }
 
-  void Add(const Prob& toAdd)
+  void Add(const BasicProb& toAdd)
   {
     this->val += toAdd.val;
   }
 
-  Prob AddNew(const Prob& toAdd) const
+  BasicProb AddNew(const BasicProb& toAdd) const
   {
     auto copy = this->Clone();
     copy.Add(toAdd);
     return copy;
   }
 
-  Prob Clone() const
+  BasicProb Clone() const
   {
-    return Prob(this->val);
+    return *this; // Not BasicProb(this->val), which would round R128 to double
   }
 
   double ToFloat() const
   {
-    return this->val;
+    return (double)this->val;
   }
 
   std::string ToStr() const
   {
-    return std::to_string((double)this->val);
+    return ProbImplToStr(this->val);
   }
 };
 
-const Prob Prob::ONE = Prob(1);
-const Prob Prob::ZERO = Prob(0);
+template<typename Impl>
+const BasicProb<Impl> BasicProb<Impl>::ONE = BasicProb<Impl>(1);
+template<typename Impl>
+const BasicProb<Impl> BasicProb<Impl>::ZERO = BasicProb<Impl>(0);
+
+/* Default implementation, used everywhere the probability type isn't a template parameter */
+using Prob = BasicProb<ProbImplType>;
 
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <cassert>
+
+#include "Types.hpp"
+#include "State.hpp"
+#include "GbaRng.hpp"
+#include "ThreadPool.hpp"
+
+/*
+RNG manipulation: with the real random number generator of the game (see GbaRng), the battle is deterministic once the
+seed at the start of the battle is known, so for each start frame, there either is an actionByTurn that catches the pokemon or not.
+
+The seed is assumed to advance once per frame before the battle: the battle starting at frame F starts with the initial seed advanced F times.
+
+For each frame of the window, a breadth-first search over actions finds the catching actionByTurn with the fewest turns,
+throwing at most ballCount balls in at most maxTurnCount turns. Two action prefixes that reach the same (seed, State, thrown ball count)
+have the same future, so only the first one is kept.
+Ex: Bait (flee check + 1 draw) and a ball that fails its first shake (flee check + 1 draw) both advance the seed twice.
+*/
+struct RngPlanner
+{
+  struct Plan
+  {
+    u32 frame = 0;
+    /* Empty if no actionByTurn catches the pokemon */
+    std::vector<PlayerAction> actionByTurn;
+
+    bool CanCatch() const
+    {
+      return !this->actionByTurn.empty();
+    }
+  };
+
+  /* maxTurnCount must be below 65536. A ball takes a turn, so ballCount above maxTurnCount is the same as maxTurnCount. */
+  RngPlanner(std::uint32_t initialSeed, int ballCount, int maxTurnCount, const State& initialState = State()) :
+    initialSeed(initialSeed),
+    ballCount(std::min(ballCount, maxTurnCount)),
+    maxTurnCount(maxTurnCount),
+    initialState(initialState)
+  {
+    assert(maxTurnCount < 65536);
+  }
+
+  /* Returns the plan of every frame from firstFrame to firstFrame + frameCount - 1, in that order. */
+  std::vector<Plan> Run(ThreadPool& threadPool, u32 firstFrame, u32 frameCount) const
+  {
+    GbaRng rng(this->initialSeed);
+    for (u32 i = 0; i < firstFrame; i++)
+      rng.Random();
+
+    std::vector<std::uint32_t> seedByFrame(frameCount);
+    for (u32 i = 0; i < frameCount; i++)
+    {
+      seedByFrame[i] = rng.seed;
+      rng.Random();
+    }
+
+    std::vector<Plan> plans(frameCount);
+    threadPool.ParallelFor(frameCount, [&](size_t i)
+      {
+        plans[i].frame = firstFrame + (u32)i;
+        plans[i].actionByTurn = GetFastestCatchActions(seedByFrame[i]);
+      });
+    return plans;
+  }
+
+private:
+  std::uint32_t initialSeed;
+  int ballCount;
+  int maxTurnCount;
+  State initialState;
+
+  struct SearchNode
+  {
+    std::uint32_t seed;
+    State state;
+    u16 thrownBallCount;
+    /* Index of the previous turn in the search nodes, -1 for the start of the battle */
+    int parentIdx;
+    PlayerAction playerAction;
+  };
+
+  /* Returns the catching actionByTurn with the fewest turns from the battle starting with <seed>, or empty if there is none. */
+  std::vector<PlayerAction> GetFastestCatchActions(std::uint32_t seed) const
+  {
+    std::vector<SearchNode> nodes;
+    nodes.push_back(SearchNode{ seed, this->initialState, 0, -1, PlayerAction::root });
+
+    // (seed, thrown ball count, State without escape and base catch factors). Both factors never change during a battle.
+    std::unordered_set<u64> visited;
+    auto Visit = [&](const SearchNode& node)
+    {
+      u32 stateId = node.state.GetId();
+      u64 key = (u64)node.seed << 32 | (u64)node.thrownBallCount << 16 | (stateId >> 8 & 0xFF00) | (stateId & 0xFF);
+      return visited.insert(key).second;
+    };
+    Visit(nodes[0]);
+
+    size_t turnBegin = 0;
+    for (int turn = 0; turn < this->maxTurnCount && turnBegin < nodes.size(); turn++)
+    {
+      size_t turnEnd = nodes.size();
+      for (size_t nodeIdx = turnBegin; nodeIdx < turnEnd; nodeIdx++)
+      {
+        for (auto playerAction : { PlayerAction::ball, PlayerAction::bait, PlayerAction::rock })
+        {
+          const SearchNode& node = nodes[nodeIdx]; // nodes may have been reallocated by push_back
+          if (playerAction == PlayerAction::ball && node.thrownBallCount >= this->ballCount)
+            continue;
+
+          GbaRng rng(node.seed);
+          State state = node.state;
+          PokemonAction pokemonAction = rng.PlayTurn(state, playerAction);
+
+          if (pokemonAction == PokemonAction::caught)
+          {
+            std::vector<PlayerAction> actionByTurn = { playerAction };
+            for (int idx = (int)nodeIdx; nodes[idx].parentIdx != -1; idx = nodes[idx].parentIdx)
+              actionByTurn.insert(actionByTurn.begin(), nodes[idx].playerAction);
+            return actionByTurn;
+          }
+          if (pokemonAction == PokemonAction::flee)
+            continue;
+
+          u16 thrownBallCount = node.thrownBallCount + (playerAction == PlayerAction::ball ? 1 : 0);
+          SearchNode child{ rng.seed, state, thrownBallCount, (int)nodeIdx, playerAction };
+          if (Visit(child))
+            nodes.push_back(child);
+        }
+      }
+      turnBegin = turnEnd;
+    }
+    return {};
+  }
+};
@@ -3,6 +3,7 @@ General idea:
   Create a graph of all branching possibilities and sum all catching probabilities.
 
   Node represents one possible way a turn can occur, after the player and pokemon perform an action.
+  BasicCompactNode is the same, but only keeps what is needed to compute the probability. Node is used to print DebugFile.
   
   State represents the bait counter, rock counter, catch rate etc.
 
@@ -30,27 +31,43 @@ Graph example:
 */
 
 #include <iostream>
+#include <cstdio>
 #include <array>
 #include <vector>
 #include <string.h>
 #include <string>
 #include <algorithm>
-#include <execution>
 #include <atomic>
+#include <type_traits>
+#include <stdexcept>
 
 #include "Types.hpp"
+#include "Actions.hpp"
 #include "Constants.hpp"
 #include "Prob.hpp"
 #include "State.hpp"
+#include "TransitionTable.hpp"
+#include "BallRun.hpp"
+#include "StateDistribution.hpp"
+#include "Batch.hpp"
+#include "OptimalSearch.hpp"
+#include "Sweep.hpp"
+#include "CompileTime.hpp"
+#include "AbsorbingChain.hpp"
+#include "MonteCarlo.hpp"
+#include "GbaRng.hpp"
+#include "RngPlanner.hpp"
+#include "ThreadPool.hpp"
+#include "WorkStealingScheduler.hpp"
 
 // ------------- Config Start
 
 u8 State::catchRate = 30;           // Chansey
 u8 State::safariZoneFleeRate = 125; // Chansey
 
-auto T = PlayerAction::bait;
-auto R = PlayerAction::rock;
-auto L = PlayerAction::ball;
+constexpr auto T = PlayerAction::bait;
+constexpr auto R = PlayerAction::rock;
+constexpr auto L = PlayerAction::ball;
 
 std::vector<PlayerAction> actionByTurn = {
     T, T, L, L, L,
@@ -61,6 +78,96 @@ std::vector<PlayerAction> actionByTurn = {
     T, L, L, T, L, L, L, L, R, L
 };
 
+/* Number of balls of the player, like montecarlo.js: actionByTurn and batchActions are padded with balls, and the battle ends
+   after the BALL_COUNT-th ball (see ApplyBallCount in Actions.hpp). 0 to end the battle when the actions are over instead.
+   Not used by REPEAT_FOREVER. SEARCH_OPTIMAL_ACTIONS and RNG_PLAN use SEARCH_BALL_COUNT. */
+const int BALL_COUNT = 30;
+
+/* Species and actions known at compile time: the catch probability is computed by the compiler (see CompileTime.hpp).
+   If USE_COMPILE_TIME_PRESET is enabled, main prints it instead of evaluating actionByTurn, so nothing is computed at runtime. */
+using CompileTimePreset = CompileTimeCatchProb<30, 125, // Chansey
+    T, T, L, L, L,
+    T, L, L, T, L, L, L,
+    T, L, L, T, L, L, L,
+    T, L, L, T, L, L, L,
+    T, L, L, T, L, L, L,
+    T, L, L, T, L, L, L, L, R, L>;
+static_assert(CompileTimePreset::value > 0.189912 && CompileTimePreset::value < 0.189913); // See README
+const bool USE_COMPILE_TIME_PRESET = 0;
+
+/* Whether to evaluate every actions of batchActions (same format as montecarlo.js) instead of actionByTurn.
+   Actions sharing a prefix only compute that prefix once. */
+const bool BATCH = 0;
+std::vector<std::string> batchActions = {
+    "TTLLL",
+    "TTLLLTLL",
+    "TTLLLTLLTLLL",
+    "TTLLLTLLTLLLL",
+};
+
+/* Whether to evaluate "repeatPrefixActions, then repeatedActions again and again until the pokemon is caught or flees" instead of actionByTurn.
+   The exact limit is computed without truncating the repetitions (see AbsorbingChain.hpp). Same format as montecarlo.js. */
+const bool REPEAT_FOREVER = 0;
+std::string repeatPrefixActions = "TT";
+std::string repeatedActions = "LLLT";
+
+/* Whether to search for the actionByTurn with the best catch probability instead of evaluating the one above.
+   The search throws at most SEARCH_BALL_COUNT balls in at most SEARCH_MAX_TURN_COUNT turns. */
+const bool SEARCH_OPTIMAL_ACTIONS = 0;
+const int SEARCH_BALL_COUNT = 30;
+const int SEARCH_MAX_TURN_COUNT = 45;
+
+/* Whether to estimate the catch probability of actionByTurn by simulating random battles (see MonteCarlo.hpp), to cross-check the exact result.
+   Stops once the 95% confidence interval is at most +/- MONTE_CARLO_MAX_HALF_WIDTH, or after MONTE_CARLO_MAX_TRIAL_COUNT battles.
+   The same seed always gives the same result.
+   MONTE_CARLO_REDUCE_VARIANCE only draws bait/rock results and computes the rest exactly, which needs far fewer battles for the same interval. */
+const bool MONTE_CARLO = 0;
+const bool MONTE_CARLO_REDUCE_VARIANCE = 1;
+const u64 MONTE_CARLO_SEED = 1;
+const u64 MONTE_CARLO_MAX_TRIAL_COUNT = 10000000000;
+const double MONTE_CARLO_MAX_HALF_WIDTH = 0.0001;
+
+/* Whether to compute the catch rate of actionByTurn with the real random number generator of the game, for the initial seeds 0 to GBA_SEED_COUNT - 1
+   (see GbaRng.hpp), and compare it with the exact result, which assumes independent draws. 2^32 covers every seed. */
+const bool GBA_SEEDS = 0;
+const u64 GBA_SEED_COUNT = 4294967296;
+
+/* Whether to plan RNG manipulation instead (see RngPlanner.hpp): for every frame of the window where the battle can start,
+   find the actions with the fewest turns that catch the pokemon, with the real random number generator of the game.
+   Uses SEARCH_BALL_COUNT and SEARCH_MAX_TURN_COUNT. */
+const bool RNG_PLAN = 0;
+const std::uint32_t RNG_PLAN_INITIAL_SEED = 0;
+const u32 RNG_PLAN_FIRST_FRAME = 0;
+const u32 RNG_PLAN_FRAME_COUNT = 3600;
+
+/* Whether to compute every species of sweepSpecies in one run instead of only catchRate and safariZoneFleeRate.
+   Uses actionByTurn (or batchActions if BATCH is enabled), or the best actions if SEARCH_OPTIMAL_ACTIONS is enabled.
+   Results are written to SweepFilename as CSV. */
+const bool SWEEP = 0;
+/* Leave empty to sweep every (catchRate, safariZoneFleeRate) pair */
+std::vector<Species> sweepSpecies = {
+    {30, 125}, // Chansey
+};
+static const char* SweepFilename = "sweep.csv";
+
+/* Whether to merge branches that lead to identical states (see StateDistribution.hpp) instead of exploring every branching possibility.
+   Much faster and supports long sequences. DebugFilename and PRINT_NODE_COUNT are only used when this is disabled. */
+const bool MERGE_IDENTICAL_STATES = 1;
+
+/* Whether to compute the catch probability of actionByTurn with double and a rigorous error bound first (see Interval.hpp),
+   and compute it again with DoubleDouble only if the error bound is above PRECISION_TOLERANCE.
+   Only used while ProbImplType of Prob.hpp is double: another ProbImplType (Ex: Dyadic<64> for the exact result) is used as is.
+   If disabled, ProbImplType is used without error bound. */
+const bool ADAPTIVE_PRECISION = 1;
+const double PRECISION_TOLERANCE = 1e-12;
+
+/* Number of threads used to explore every branching possibility and to sweep species. 0 means one thread per core. */
+const size_t THREAD_COUNT = 0;
+
+/* Whether exploring every branching possibility on several threads must give a bit-identical result for any THREAD_COUNT.
+   If disabled, tasks are shared with work stealing, which is slightly better balanced, but the last bits of the result can differ between runs. */
+const bool DETERMINISTIC_SUM = 1;
+
 /* File where to print the graph of all nodes used for debugging. Not recommended when many actions are used, because the file size becomes enormous. */
 static const char* DebugFilename = nullptr; // "C:\\rc\\safari.txt";
 
@@ -72,6 +179,18 @@ const bool PRINT_NODE_COUNT = 0;
 static constexpr int MAX_CHILD_COUNT = 10;
 static FILE* DebugFile = nullptr;
 
+/* nullptr if the file can't be opened. fopen_s is MSVC only, and MSVC warns about fopen. */
+static FILE* OpenFile(const char* filename, const char* mode)
+{
+#if defined(_MSC_VER)
+  FILE* file = nullptr;
+  fopen_s(&file, filename, mode);
+  return file;
+#else
+  return std::fopen(filename, mode);
+#endif
+}
+
 struct Node
 {
   static std::atomic<size_t> NodeCount;
@@ -95,7 +214,7 @@ struct Node
   /* The action performed by the pokemon on this turn */
   PokemonAction pokemonAction = PokemonAction::root2;
   /** -1 for root */
-  signed char turn = -1;
+  short turn = -1;
 
   /* Root */
   Node() = default;
@@ -134,22 +253,8 @@ struct Node
     }
 
     Prob childrenProbSum(0);
-
-    // To improve performance, for early turns, calculate in parallel instead of in sequence
-    if (this->turn < actionByTurn.size() / 2)
-    {
-      Prob childrenProb[MAX_CHILD_COUNT];
-      std::transform(std::execution::par_unseq, children, children + childCount, childrenProb, [](const auto& child)
-        {  return child.GetProbThatChildrenWillCatchPokemon(); });
-
-      for (size_t i = 0; i < childCount; i++)
-        childrenProbSum.Add(childrenProb[i]);
-    }
-    else
-    {
-      for (size_t i = 0; i < childCount; i++)
-        childrenProbSum.Add(children[i].GetProbThatChildrenWillCatchPokemon());
-    }
+    for (size_t i = 0; i < childCount; i++)
+      childrenProbSum.Add(children[i].GetProbThatChildrenWillCatchPokemon());
 
     return childrenProbSum;
   }
@@ -159,7 +264,7 @@ struct Node
     if (this->IsCaught() || this->Fled())
       return;
 
-    if (this->turn + 1 >= actionByTurn.size())
+    if (this->turn + 1 >= (int)actionByTurn.size())
       return;
 
     PlayerAction childPlayerAction = actionByTurn[this->turn + 1];
@@ -172,84 +277,13 @@ struct Node
       children[childCount++] = Node(*this, playerActionProb, stayProb, playerValue, PokemonAction::watchCarefully);
     };
 
-    static const Prob mod5_eq0(13108, 65536); // RandomUint16 % 5 is more likely to be 0 than 1,2,3,4
-    static const Prob mod5_eq1234(13107, 65536);
-    
-    static const Prob mod5_eq1234_mul2 = mod5_eq1234.MulNew(2);
-    static const Prob mod5_eq1234_mul3 = mod5_eq1234.MulNew(3);
-    static const Prob mod5_eq1234_mul4 = mod5_eq1234.MulNew(4);
-
-    if (childPlayerAction == PlayerAction::ball)
-    {
-      const auto& [catchProb, missProb] = this->stateAfter.GetCatchMissProb();
-
-      children[childCount++] = Node(*this, catchProb, Prob::ONE, 1, PokemonAction::caught);
-
-      AddChildren(0, missProb);
-    }
-    else if (childPlayerAction == PlayerAction::bait)
-    {
-      if (this->stateAfter.safariBaitThrowCounter == 0)
-      {
-        AddChildren(2, mod5_eq0);
-        AddChildren(3, mod5_eq1234);
-        AddChildren(4, mod5_eq1234);
-        AddChildren(5, mod5_eq1234);
-        AddChildren(6, mod5_eq1234);
-      }
-      else if (this->stateAfter.safariBaitThrowCounter == 1)
-      {
-        AddChildren(3, mod5_eq0);
-        AddChildren(4, mod5_eq1234);
-        AddChildren(5, mod5_eq1234);
-        AddChildren(6, mod5_eq1234_mul2);
-      }
-      else if (this->stateAfter.safariBaitThrowCounter == 2)
-      {
-        AddChildren(4, mod5_eq0);
-        AddChildren(5, mod5_eq1234);
-        AddChildren(6, mod5_eq1234_mul3);
-      }
-      else if (this->stateAfter.safariBaitThrowCounter == 3)
-      {
-        AddChildren(5, mod5_eq0);
-        AddChildren(6, mod5_eq1234_mul4);
-      }
-      else
-        AddChildren(6, Prob::ONE);
-    }
-
-    else if (childPlayerAction == PlayerAction::rock)
-    {
-      if (this->stateAfter.safariRockThrowCounter == 0)
-      {
-        AddChildren(2, mod5_eq0);
-        AddChildren(3, mod5_eq1234);
-        AddChildren(4, mod5_eq1234);
-        AddChildren(5, mod5_eq1234);
-        AddChildren(6, mod5_eq1234);
-      }
-      else if (this->stateAfter.safariRockThrowCounter == 1)
-      {
-        AddChildren(3, mod5_eq0);
-        AddChildren(4, mod5_eq1234);
-        AddChildren(5, mod5_eq1234);
-        AddChildren(6, mod5_eq1234_mul2);
-      }
-      else if (this->stateAfter.safariRockThrowCounter == 2)
+    this->stateAfter.ForEachPlayerActionValue(childPlayerAction, [&](u8 playerValue, const Prob& playerActionProb)
       {
-        AddChildren(4, mod5_eq0);
-        AddChildren(5, mod5_eq1234);
-        AddChildren(6, mod5_eq1234_mul3);
-      }
-      else if (this->stateAfter.safariRockThrowCounter == 3)
-      {
-        AddChildren(5, mod5_eq0);
-        AddChildren(6, mod5_eq1234_mul4);
-      }
-      else
-        AddChildren(6, Prob::ONE);
-    }
+        if (childPlayerAction == PlayerAction::ball && playerValue == 1)
+          children[childCount++] = Node(*this, playerActionProb, Prob::ONE, 1, PokemonAction::caught);
+        else
+          AddChildren(playerValue, playerActionProb);
+      });
   }
 
   PlayerAction GetPlayerAction() const
@@ -324,20 +358,372 @@ struct Node
 
 std::atomic<size_t> Node::NodeCount = 0;
 
+/*
+What every BasicCompactNode of a graph shares. Passed to each traversal instead of being stored in the nodes (nodes stay small)
+or in statics (several graphs can be explored at the same time). The tables must outlive the traversal.
+*/
+template<typename P>
+struct BasicCompactNodeContext
+{
+  /* Transitions of the species */
+  const BasicTransitionTable<P>& table;
+  /* Runs of balls of actionByTurn */
+  const BasicBallRunTable<P>& ballRuns;
+};
+
+/*
+Lean version of Node used to explore the graph when DebugFile is not used.
+Only what is needed to compute the catch probability is kept, so many more nodes fit in the CPU cache.
+P is the probability type (Prob by default, see BasicProb).
+*/
+template<typename P>
+struct BasicCompactNode
+{
+  static constexpr size_t MAX_TURN_COUNT = 65534;
+
+  /* Same as Node::probConsideringParents */
+  P probConsideringParents = P::ONE;
+  /* turn + 1 (bits 16-31), index of stateAfter in table (bits 0-15). So actionByTurn has at most MAX_TURN_COUNT turns. */
+  u32 packed = 0;
+
+  BasicCompactNode() = default;
+
+  BasicCompactNode(int turn, u16 stateIdx, const P& probConsideringParents) :
+    probConsideringParents(probConsideringParents),
+    packed((u32)(turn + 1) << 16 | stateIdx)
+  {
+    if (PRINT_NODE_COUNT)
+      Node::NodeCount++;
+  }
+
+  int GetTurn() const
+  {
+    return (int)(u16)(this->packed >> 16) - 1;
+  }
+
+  u16 GetStateIdx() const
+  {
+    return (u16)this->packed;
+  }
+
+  /* Adds the probability of children catching the pokemon to <caughtProbSum>, ignores children where the pokemon flees,
+     and calls onChild(BasicCompactNode) for children where the pokemon watches carefully.
+     A run of balls has a single child where the pokemon watches carefully, after the last ball of the run (see BasicBallRun). */
+  template<typename F>
+  void ForEachChild(const BasicCompactNodeContext<P>& context, P& caughtProbSum, F&& onChild) const
+  {
+    int childTurn = this->GetTurn() + 1;
+    if (childTurn >= (int)actionByTurn.size())
+      return;
+
+    int ballRunLength = context.ballRuns.GetRunLength(childTurn);
+    if (ballRunLength != 0)
+    {
+      const auto& run = context.ballRuns.GetRun(childTurn, this->GetStateIdx());
+      caughtProbSum.Add(this->probConsideringParents.MulNew(run.caughtProb));
+      onChild(BasicCompactNode(childTurn + ballRunLength - 1, run.nextStateIdx, this->probConsideringParents.MulNew(run.ongoingProb)));
+      return;
+    }
+
+    PlayerAction childPlayerAction = actionByTurn[childTurn];
+
+    auto end = context.table.EndOutcomes(this->GetStateIdx(), childPlayerAction);
+    for (auto outcome = context.table.BeginOutcomes(this->GetStateIdx(), childPlayerAction); outcome != end; outcome++)
+    {
+      if (outcome->pokemonAction == PokemonAction::flee)
+        continue;
+
+      P childProb = this->probConsideringParents;
+      childProb.Mul(outcome->prob);
+
+      if (outcome->pokemonAction == PokemonAction::caught)
+        caughtProbSum.Add(childProb);
+      else
+        onChild(BasicCompactNode(childTurn, outcome->nextStateIdx, childProb));
+    }
+  }
+
+  /* Same as Node::GetProbThatChildrenWillCatchPokemon, but without recursion (no depth limit) and without creating leaf nodes:
+     a catch is added to the sum right away, a flee is ignored, and only nodes where the pokemon watches carefully are pushed to the stack. */
+  P GetProbThatChildrenWillCatchPokemon(const BasicCompactNodeContext<P>& context) const
+  {
+    thread_local std::vector<BasicCompactNode> stack;
+    stack.clear();
+    stack.push_back(*this);
+
+    P childrenProbSum(0);
+
+    while (!stack.empty())
+    {
+      BasicCompactNode node = stack.back();
+      stack.pop_back();
+      node.ForEachChild(context, childrenProbSum, [&](const BasicCompactNode& child) { stack.push_back(child); });
+    }
+
+    return childrenProbSum;
+  }
+
+  /* Same as GetProbThatChildrenWillCatchPokemon, but the graph is split between the threads of <threadPool>.
+     Subtrees whose estimated size is above 1/TASK_COUNT_TARGET of the graph are split into one task per child,
+     smaller ones are explored by a single thread. */
+  P GetProbThatChildrenWillCatchPokemonInParallel(ThreadPool& threadPool, const BasicCompactNodeContext<P>& context) const
+  {
+    std::vector<double> nodeCountByTurn = GetNodeCountByTurn();
+    double minNodeCountToSplit = GetMinNodeCountToSplit(nodeCountByTurn);
+
+    struct alignas(64) ThreadProb
+    {
+      P prob = P::ZERO;
+    };
+
+    WorkStealingScheduler<BasicCompactNode> scheduler(threadPool);
+    std::vector<ThreadProb> probByThread(scheduler.GetThreadCount());
+
+    scheduler.Run(*this, [&](const BasicCompactNode& node, auto& worker)
+      {
+        P& threadProb = probByThread[worker.idx].prob;
+
+        if (nodeCountByTurn[node.GetTurn() + 1] < minNodeCountToSplit)
+          threadProb.Add(node.GetProbThatChildrenWillCatchPokemon(context));
+        else
+          node.ForEachChild(context, threadProb, [&](const BasicCompactNode& child) { worker.Spawn(child); });
+      });
+
+    P sum(0);
+    for (const auto& threadProb : probByThread)
+      sum.Add(threadProb.prob);
+    return sum;
+  }
+
+  /* Same as GetProbThatChildrenWillCatchPokemonInParallel, but the result is bit-identical for any number of threads.
+     With work stealing, the sum of each thread depends on which tasks it happened to run, so the rounding differs between runs.
+     Here, big subtrees are split by the calling thread, always in the same order, then every task result is stored
+     at its own index and the results are summed in that order once all threads are done. */
+  P GetProbThatChildrenWillCatchPokemonInParallelDeterministic(ThreadPool& threadPool, const BasicCompactNodeContext<P>& context) const
+  {
+    std::vector<double> nodeCountByTurn = GetNodeCountByTurn();
+    double minNodeCountToSplit = GetMinNodeCountToSplit(nodeCountByTurn);
+
+    P splitProbSum(0); // Catches that are direct children of split nodes
+    std::vector<BasicCompactNode> tasks;
+    std::vector<BasicCompactNode> stack = { *this };
+    while (!stack.empty())
+    {
+      BasicCompactNode node = stack.back();
+      stack.pop_back();
+
+      if (nodeCountByTurn[node.GetTurn() + 1] < minNodeCountToSplit)
+        tasks.push_back(node);
+      else
+        node.ForEachChild(context, splitProbSum, [&](const BasicCompactNode& child) { stack.push_back(child); });
+    }
+
+    std::vector<P> probByTask(tasks.size());
+    threadPool.ParallelFor(tasks.size(), [&](size_t taskIdx)
+      {
+        probByTask[taskIdx] = tasks[taskIdx].GetProbThatChildrenWillCatchPokemon(context);
+      });
+
+    P sum = splitProbSum;
+    for (const auto& prob : probByTask)
+      sum.Add(prob);
+    return sum;
+  }
+
+private:
+  static constexpr double TASK_COUNT_TARGET = 4096;
+
+  /* nodeCountByTurn[turn + 1]: Estimated number of nodes in the subtree of a node of <turn> where the pokemon watched carefully */
+  static std::vector<double> GetNodeCountByTurn()
+  {
+    std::vector<double> nodeCountByTurn(actionByTurn.size() + 1, 1);
+    for (int turn = (int)actionByTurn.size() - 2; turn >= -1; turn--)
+    {
+      double childNodeCount = nodeCountByTurn[turn + 2];
+      if (actionByTurn[turn + 1] == PlayerAction::ball)
+        nodeCountByTurn[turn + 1] = 1 + childNodeCount; // miss then watch
+      else
+        nodeCountByTurn[turn + 1] = 1 + 5 * childNodeCount; // up to 5 bait/rock values, then watch
+    }
+    return nodeCountByTurn;
+  }
+
+  /* Subtrees smaller than this are explored by a single thread. Only depends on actionByTurn, not on the thread count. */
+  double GetMinNodeCountToSplit(const std::vector<double>& nodeCountByTurn) const
+  {
+    return std::max(nodeCountByTurn[this->GetTurn() + 1] / TASK_COUNT_TARGET, 1000.);
+  }
+};
+
+/* Catch probability of actionByTurn, computed with probabilities of type P, by merging identical states or by exploring every branching possibility.
+   Throws std::length_error if actionByTurn is too long to explore every branching possibility. */
+template<typename P>
+P GetCatchProb(ThreadPool& threadPool)
+{
+  if (MERGE_IDENTICAL_STATES)
+    return BasicStateDistribution<P>::GetCatchProb(actionByTurn);
+
+  if (actionByTurn.size() > BasicCompactNode<P>::MAX_TURN_COUNT)
+    throw std::length_error("Without MERGE_IDENTICAL_STATES, actionByTurn can't have more than "
+      + std::to_string(BasicCompactNode<P>::MAX_TURN_COUNT) + " turns (it has " + std::to_string(actionByTurn.size()) + ")");
+
+  BasicTransitionTable<P> table{ State() };
+  BasicBallRunTable<P> ballRuns(table, actionByTurn);
+  BasicCompactNodeContext<P> context{ table, ballRuns };
+  BasicCompactNode<P> root(-1, 0, P::ONE);
+  if (DETERMINISTIC_SUM)
+    return root.GetProbThatChildrenWillCatchPokemonInParallelDeterministic(threadPool, context);
+  return root.GetProbThatChildrenWillCatchPokemonInParallel(threadPool, context);
+}
+
 int main()
 {
   if (DebugFilename != nullptr)
-    fopen_s(&DebugFile, DebugFilename,"w");
+    DebugFile = OpenFile(DebugFilename, "w");
 
   auto begin = std::chrono::steady_clock::now();
 
-  Node root;
-  Prob catchProb = root.GetProbThatChildrenWillCatchPokemon();
+  ThreadPool threadPool(THREAD_COUNT);
+
+  if (SWEEP)
+  {
+    FILE* sweepFile = OpenFile(SweepFilename, "w");
+    if (sweepFile == nullptr)
+    {
+      std::cout << "Can't open " << SweepFilename << "\n";
+      return 1;
+    }
+
+    auto speciesList = sweepSpecies.empty() ? Sweep::GetAllSpecies() : sweepSpecies;
+    if (SEARCH_OPTIMAL_ACTIONS)
+      Sweep::SearchOptimalActions(speciesList, SEARCH_BALL_COUNT, SEARCH_MAX_TURN_COUNT, sweepFile, threadPool);
+    else if (BATCH)
+    {
+      std::vector<std::vector<PlayerAction>> actionByTurnList;
+      for (const auto& actions : batchActions)
+        actionByTurnList.push_back(StrToActions(actions));
+      Sweep::EvaluateActions(speciesList, actionByTurnList, BALL_COUNT, sweepFile, threadPool);
+    }
+    else
+      Sweep::EvaluateActions(speciesList, { actionByTurn }, BALL_COUNT, sweepFile, threadPool);
+    fclose(sweepFile);
+
+    auto end = std::chrono::steady_clock::now();
+    std::cout << speciesList.size() << " species written to " << SweepFilename << "\n";
+    std::cout << "Time = " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "ms" << std::endl;
+    return 0;
+  }
+
+  if (RNG_PLAN)
+  {
+    RngPlanner planner(RNG_PLAN_INITIAL_SEED, SEARCH_BALL_COUNT, SEARCH_MAX_TURN_COUNT);
+    auto plans = planner.Run(threadPool, RNG_PLAN_FIRST_FRAME, RNG_PLAN_FRAME_COUNT);
+
+    size_t catchFrameCount = 0;
+    const RngPlanner::Plan* fastestPlan = nullptr;
+    for (const auto& plan : plans)
+    {
+      if (!plan.CanCatch())
+        continue;
+      catchFrameCount++;
+      std::cout << "Frame " << plan.frame << ": " << ActionsToStr(plan.actionByTurn) << "\n";
+      if (fastestPlan == nullptr || plan.actionByTurn.size() < fastestPlan->actionByTurn.size())
+        fastestPlan = &plan;
+    }
+
+    std::cout << catchFrameCount << " / " << plans.size() << " frames can catch the pokemon.\n";
+    if (fastestPlan != nullptr)
+      std::cout << "Fastest: frame " << fastestPlan->frame << ", " << ActionsToStr(fastestPlan->actionByTurn) << "\n";
+
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Time = " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "ms" << std::endl;
+    return 0;
+  }
+
+  if (BATCH && !SEARCH_OPTIMAL_ACTIONS)
+  {
+    // Labels are the actions as typed in batchActions, not padded
+    std::vector<std::vector<PlayerAction>> actionByTurnList;
+    for (const auto& actions : batchActions)
+      actionByTurnList.push_back(ApplyBallCount(StrToActions(actions), BALL_COUNT));
+
+    auto catchProbs = Batch::GetCatchProbs(actionByTurnList);
+    for (size_t i = 0; i < batchActions.size(); i++)
+      std::cout << batchActions[i] << ": Catch probability = " << catchProbs[i].ToStr() << "\n";
+
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Time = " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() << "us" << std::endl;
+    return 0;
+  }
+
+  actionByTurn = ApplyBallCount(actionByTurn, BALL_COUNT);
+
+  std::string catchProbStr;
+  try
+  {
+    if (USE_COMPILE_TIME_PRESET)
+      catchProbStr = Prob(CompileTimePreset::value).ToStr();
+    else if (SEARCH_OPTIMAL_ACTIONS)
+    {
+      OptimalSearch search(SEARCH_BALL_COUNT, SEARCH_MAX_TURN_COUNT);
+      auto result = search.Run();
+      catchProbStr = result.catchProb.ToStr();
+      std::cout << "Best actions = " << ActionsToStr(result.actionByTurn) << "\n";
+      std::cout << search.GetExploredPrefixCount() << " action prefixes explored.\n";
+    }
+    else if (REPEAT_FOREVER)
+      catchProbStr = Prob(AbsorbingChain::GetCatchProb(StrToActions(repeatPrefixActions), StrToActions(repeatedActions))).ToStr();
+    else if (MONTE_CARLO)
+    {
+      MonteCarlo monteCarlo(actionByTurn, MONTE_CARLO_SEED, MONTE_CARLO_REDUCE_VARIANCE);
+      auto result = monteCarlo.Run(threadPool, MONTE_CARLO_MAX_TRIAL_COUNT, MONTE_CARLO_MAX_HALF_WIDTH);
+      char str[64];
+      snprintf(str, sizeof(str), "%f +/- %.1e", result.catchProb, result.halfWidth);
+      catchProbStr = str;
+      std::cout << result.trialCount << " battles simulated.\n";
+    }
+    else if (GBA_SEEDS)
+    {
+      GbaSeedEnumerator enumerator(actionByTurn);
+      u64 caughtSeedCount = enumerator.GetCaughtSeedCount(threadPool, 0, GBA_SEED_COUNT);
+      double catchRate = (double)caughtSeedCount / GBA_SEED_COUNT;
+      double independentCatchProb = StateDistribution::GetCatchProb(actionByTurn).ToFloat();
+
+      std::cout << caughtSeedCount << " / " << GBA_SEED_COUNT << " seeds catch the pokemon.\n";
+      std::cout << "Catch probability with independent draws = " << std::to_string(independentCatchProb)
+        << " (difference: " << catchRate - independentCatchProb << ")\n";
+      catchProbStr = std::to_string(catchRate);
+    }
+    else if (!MERGE_IDENTICAL_STATES && DebugFile != nullptr)
+    {
+      // The debug file lists every node depth-first, which requires Node and a single thread
+      Node root;
+      catchProbStr = root.GetProbThatChildrenWillCatchPokemon().ToStr();
+    }
+    else if (ADAPTIVE_PRECISION && std::is_same_v<ProbImplType, double>)
+    {
+      auto intervalProb = GetCatchProb<BasicProb<Interval>>(threadPool);
+      catchProbStr = intervalProb.ToStr();
+
+      if (intervalProb.val.GetError() > PRECISION_TOLERANCE)
+      {
+        std::cout << "Error bound of double (" << catchProbStr << ") is above PRECISION_TOLERANCE, computing again with DoubleDouble.\n";
+        catchProbStr = GetCatchProb<BasicProb<DoubleDouble>>(threadPool).ToStr();
+      }
+    }
+    else
+      catchProbStr = GetCatchProb<Prob>(threadPool).ToStr();
+  }
+  catch (const std::length_error& error)
+  {
+    std::cout << error.what() << "\n";
+    return 1;
+  }
 
-  std::cout << "Catch probability = " << catchProb.ToStr() << "\n";
+  std::cout << "Catch probability = " << catchProbStr << "\n";
 
   auto end = std::chrono::steady_clock::now();
-  std::cout << "Time = " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "ms" << std::endl; // ~500ms
+  std::cout << "Time = " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() << "us" << std::endl; // ~500ms without MERGE_IDENTICAL_STATES
 
   if (Node::NodeCount != 0)
     std::cout << Node::NodeCount << " possibilities explored.";
@@ -6,6 +6,7 @@
 
 struct State
 {
+  /* Species used by State(). Other species can be used in the same process with State(catchRate, safariZoneFleeRate). */
   static u8 catchRate;
   static u8 safariZoneFleeRate;
 
@@ -13,18 +14,32 @@ struct State
   u8 safariCatchFactor = 0;
   u8 safariBaitThrowCounter = 0;
   u8 safariRockThrowCounter = 0;
+  /* safariCatchFactor of the species, restored when the rock counter reaches 0 */
+  u8 safariBaseCatchFactor = 0;
 
   State(const State&) = default;
 
-  State()
+  State() : State(State::catchRate, State::safariZoneFleeRate) {}
+
+  constexpr State(u8 catchRate, u8 safariZoneFleeRate)
   {
-    this->safariCatchFactor = (u8)(State::catchRate * 100 / 1275);
-    this->safariEscapeFactor = (u8)(State::safariZoneFleeRate * 100 / 1275);
+    this->safariBaseCatchFactor = (u8)(catchRate * 100 / 1275);
+    this->safariCatchFactor = this->safariBaseCatchFactor;
+    this->safariEscapeFactor = (u8)(safariZoneFleeRate * 100 / 1275);
     if (this->safariEscapeFactor <= 1)
       this->safariEscapeFactor = 2;
   }
 
-  const std::pair<const Prob, const Prob>& GetStayFleeProb() const
+  /* Unique identifier of the state. Two states with the same id always have the same future.
+     Catch and escape factors are at most 20 (255 * 100 / 1275) and counters at most 6. */
+  constexpr u32 GetId() const
+  {
+    return (u32)this->safariEscapeFactor << 24 | (u32)this->safariCatchFactor << 16 | (u32)this->safariBaseCatchFactor << 8
+      | (u32)this->safariBaitThrowCounter << 4 | this->safariRockThrowCounter;
+  }
+
+  /* Percentage of chance that the pokemon flees this turn, before the player action. Index of StayFleeProbBySafariFleeRate() */
+  constexpr u8 GetSafariFleeRate() const
   {
     u8 safariFleeRate;
 
@@ -43,17 +58,75 @@ struct State
     else
       safariFleeRate = this->safariEscapeFactor;
 
-    safariFleeRate *= 5;
+    return safariFleeRate * 5;
+  }
+
+  template<typename P = Prob>
+  const std::pair<const P, const P>& GetStayFleeProb() const
+  {
+    return StayFleeProbBySafariFleeRate<P>()[this->GetSafariFleeRate()];
+  }
+
+  template<typename P = Prob>
+  const std::pair<const P, const P>& GetCatchMissProb() const
+  {
+    return CatchMissProbBySafariCatchFactor<P>()[this->safariCatchFactor];
+  }
+
+  /* Calls onPlayerActionValue(playerActionValue, playerActionProb) for every possible result of the player action.
+     For bait/rock, playerActionValue is the number of bait/rock after the action.
+     For ball, playerActionValue is 1 if catch, 0 if miss. Catch is always listed first.
+     playerActionProb is a P. */
+  template<typename P = Prob, typename F>
+  void ForEachPlayerActionValue(PlayerAction playerAction, F&& onPlayerActionValue) const
+  {
+    if (playerAction == PlayerAction::ball)
+    {
+      const auto& [catchProb, missProb] = this->GetCatchMissProb<P>();
+      onPlayerActionValue(1, catchProb);
+      onPlayerActionValue(0, missProb);
+      return;
+    }
+
+    u8 counter = playerAction == PlayerAction::bait ? this->safariBaitThrowCounter : this->safariRockThrowCounter;
 
-    return StayFleeProbBySafariFleeRate[safariFleeRate];
+    ForEachCounterValue(counter, [&](u8 counterAfter, u32 count)
+      {
+        onPlayerActionValue(counterAfter, P(count, 65536));
+      });
+  }
+
+  /* Calls onCounterValue(counterAfter, count) for every possible bait/rock counter after throwing a bait/rock,
+     where count is the number of RandomUint16 values (out of 65536) that lead to counterAfter.
+     Bait and rock both add RandomUint16 % 5 + 2 to their counter, capped at 6.
+     Ex: For counter 1: {3, 13108}, {4, 13107}, {5, 13107}, {6, 26214} */
+  template<typename F>
+  static constexpr void ForEachCounterValue(u8 counter, F&& onCounterValue)
+  {
+    u8 counterAfter = 0;
+    u32 count = 0;
+
+    for (u32 mod5 = 0; mod5 < 5; mod5++)
+    {
+      u8 value = GetCounterAfter(counter, mod5);
+      if (value != counterAfter && count != 0)
+      {
+        onCounterValue(counterAfter, count);
+        count = 0;
+      }
+      counterAfter = value;
+      count += mod5 == 0 ? 13108 : 13107; // RandomUint16 % 5 is more likely to be 0 than 1,2,3,4
+    }
+    onCounterValue(counterAfter, count);
   }
 
-  const std::pair<const Prob, const Prob>& GetCatchMissProb() const
+  /* Bait/rock counter after throwing a bait/rock, where mod5 is RandomUint16 % 5 */
+  static constexpr u8 GetCounterAfter(u8 counter, u32 mod5)
   {
-    return CatchMissProbBySafariCatchFactor[this->safariCatchFactor];
+    return counter + mod5 + 2 > 6 ? 6 : (u8)(counter + mod5 + 2);
   }
 
-  State ApplyActions(PlayerAction playerAction, u8 playerActionValue, PokemonAction pokemonAction) const
+  constexpr State ApplyActions(PlayerAction playerAction, u8 playerActionValue, PokemonAction pokemonAction) const
   {
     State newState = *this;
     if (pokemonAction == PokemonAction::flee)
@@ -70,7 +143,7 @@ struct State
     return newState;
   }
 
-  void OnRock(u8 playerActionValue)
+  constexpr void OnRock(u8 playerActionValue)
   {
     this->safariRockThrowCounter = playerActionValue;
     this->safariBaitThrowCounter = 0;
@@ -79,7 +152,7 @@ struct State
       this->safariCatchFactor = 20;
   }
 
-  void OnBait(u8 safariBaitThrowCounter)
+  constexpr void OnBait(u8 safariBaitThrowCounter)
   {
     this->safariBaitThrowCounter = safariBaitThrowCounter;
     this->safariRockThrowCounter = 0;
@@ -88,13 +161,13 @@ struct State
       this->safariCatchFactor = 3;
   }
 
-  void OnPokemonWatchesCarefully()
+  constexpr void OnPokemonWatchesCarefully()
   {
     if (this->safariRockThrowCounter != 0)
     {
       --this->safariRockThrowCounter;
       if (this->safariRockThrowCounter == 0)
-        this->safariCatchFactor = (u8)(State::catchRate * 100 / 1275);
+        this->safariCatchFactor = this->safariBaseCatchFactor;
     }
     else if (this->safariBaitThrowCounter != 0)
       --this->safariBaitThrowCounter;
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "Types.hpp"
+#include "Prob.hpp"
+#include "State.hpp"
+#include "TransitionTable.hpp"
+#include "Actions.hpp"
+#include "BallRun.hpp"
+
+/*
+Alternative to the Node graph: instead of exploring every branching possibility, keep, for the current turn,
+the absolute probability of being in each distinct State. Branches that lead to identical states are merged,
+so the cost grows with turns * distinct states instead of exponentially.
+
+Ex: After Bait, Bait, the Node graph has 50 branches where the pokemon stayed, but only 5 distinct states (B2 to B6).
+
+P is the probability type (Prob by default, see BasicProb).
+*/
+template<typename P>
+struct BasicStateDistribution
+{
+  struct Entry
+  {
+    /* Index in TransitionTable::states */
+    u16 stateIdx;
+    /* Absolute probability that the battle is ongoing and in this state */
+    P prob;
+  };
+
+  /* Must outlive the distribution */
+  const BasicTransitionTable<P>* table;
+
+  /* Sorted by stateIdx */
+  std::vector<Entry> entries;
+
+  /* Absolute probability that the pokemon was caught in a previous turn */
+  P caughtProb = P::ZERO;
+
+  /* Before the first turn */
+  BasicStateDistribution(const BasicTransitionTable<P>& table) :
+    table(&table)
+  {
+    this->entries.push_back(Entry{ 0, P::ONE });
+  }
+
+  const State& GetState(const Entry& entry) const
+  {
+    return this->table->states[entry.stateIdx];
+  }
+
+  /* Advances the distribution by one turn where the player performs <playerAction>. */
+  void ApplyAction(PlayerAction playerAction)
+  {
+    // Probabilities of identical states are summed in probByStateIdx
+    thread_local std::vector<P> probByStateIdx;
+    thread_local std::vector<bool> reachedByStateIdx;
+    probByStateIdx.assign(this->table->states.size(), P::ZERO);
+    reachedByStateIdx.assign(this->table->states.size(), false);
+
+    for (const auto& entry : this->entries)
+    {
+      auto end = this->table->EndOutcomes(entry.stateIdx, playerAction);
+      for (auto outcome = this->table->BeginOutcomes(entry.stateIdx, playerAction); outcome != end; outcome++)
+      {
+        // If the pokemon flees, the branch is over and never catches the pokemon
+        if (outcome->pokemonAction == PokemonAction::flee)
+          continue;
+
+        P prob = entry.prob;
+        prob.Mul(outcome->prob);
+
+        if (outcome->pokemonAction == PokemonAction::caught)
+          this->caughtProb.Add(prob);
+        else
+        {
+          probByStateIdx[outcome->nextStateIdx].Add(prob);
+          reachedByStateIdx[outcome->nextStateIdx] = true;
+        }
+      }
+    }
+
+    this->entries.clear();
+    for (size_t stateIdx = 0; stateIdx < probByStateIdx.size(); stateIdx++)
+      if (reachedByStateIdx[stateIdx])
+        this->entries.push_back(Entry{ (u16)stateIdx, probByStateIdx[stateIdx] });
+  }
+
+  /* Advances the distribution by <ballCount> turns where the player throws a ball, with BasicBallRun instead of turn by turn. */
+  void ApplyBallRun(u64 ballCount)
+  {
+    thread_local std::vector<P> probByStateIdx;
+    thread_local std::vector<bool> reachedByStateIdx;
+    probByStateIdx.assign(this->table->states.size(), P::ZERO);
+    reachedByStateIdx.assign(this->table->states.size(), false);
+
+    for (const auto& entry : this->entries)
+    {
+      BasicBallRun<P> run(*this->table, entry.stateIdx, ballCount);
+      this->caughtProb.Add(entry.prob.MulNew(run.caughtProb));
+      probByStateIdx[run.nextStateIdx].Add(entry.prob.MulNew(run.ongoingProb));
+      reachedByStateIdx[run.nextStateIdx] = true;
+    }
+
+    this->entries.clear();
+    for (size_t stateIdx = 0; stateIdx < probByStateIdx.size(); stateIdx++)
+      if (reachedByStateIdx[stateIdx])
+        this->entries.push_back(Entry{ (u16)stateIdx, probByStateIdx[stateIdx] });
+  }
+
+  /* Applies actionByTurn[begin] to actionByTurn[end - 1]. Runs of balls are applied with ApplyBallRun. */
+  void ApplyActions(const std::vector<PlayerAction>& actionByTurn, size_t begin, size_t end)
+  {
+    for (size_t turn = begin; turn < end;)
+    {
+      size_t runEnd = turn;
+      while (runEnd < end && actionByTurn[runEnd] == PlayerAction::ball)
+        runEnd++;
+
+      if (runEnd - turn >= 2)
+      {
+        this->ApplyBallRun(runEnd - turn);
+        turn = runEnd;
+      }
+      else
+        this->ApplyAction(actionByTurn[turn++]);
+    }
+  }
+
+  /* Advances the distribution by <blockActions>, <repeatCount> times in a row.
+     For many repetitions, the block is turned into a transition matrix M (see BlockMatrix), and the distribution is multiplied
+     by M^repeatCount with repeated squaring: log2(repeatCount) matrix products instead of repeatCount * blockActions.size() turns.
+     A matrix product costs ~n^3 for n states, so turn by turn is kept when it is cheaper.
+     Ex: For Chansey (72 states) and a block of 7 actions, the matrix is used above ~2500 repetitions (for 10000 repetitions, 4ms instead of 20ms). */
+  void ApplyRepeatedActions(const std::vector<PlayerAction>& blockActions, u64 repeatCount)
+  {
+    if (std::all_of(blockActions.begin(), blockActions.end(), [](PlayerAction playerAction) { return playerAction == PlayerAction::ball; }))
+    {
+      this->ApplyBallRun(blockActions.size() * repeatCount);
+      return;
+    }
+
+    u64 squaringCount = 0;
+    for (u64 k = repeatCount; k > 1; k >>= 1)
+      squaringCount++;
+
+    // Rough number of multiplications. A turn has ~7 outcomes per state.
+    double n = (double)this->table->states.size() + 1;
+    double turnByTurnCost = (double)repeatCount * blockActions.size() * n * 7;
+    double matrixCost = blockActions.size() * n * n * 7 + 2 * squaringCount * n * n * n;
+    if (turnByTurnCost <= matrixCost)
+    {
+      for (u64 i = 0; i < repeatCount; i++)
+        this->ApplyActions(blockActions, 0, blockActions.size());
+      return;
+    }
+
+    BlockMatrix power = GetBlockMatrix(blockActions);
+    BlockMatrix distribution(1, power.n);
+    for (const auto& entry : this->entries)
+      distribution.Set(0, entry.stateIdx, entry.prob);
+    distribution.Set(0, power.n - 1, this->caughtProb);
+
+    // distribution * M^repeatCount = distribution * M^(bit0 * 1) * M^(bit1 * 2) * M^(bit2 * 4) ...
+    for (u64 k = repeatCount; k > 0; k >>= 1)
+    {
+      if (k & 1)
+        distribution = distribution.MulNew(power);
+      if (k > 1)
+        power = power.MulNew(power);
+    }
+
+    this->entries.clear();
+    for (size_t stateIdx = 0; stateIdx + 1 < power.n; stateIdx++)
+      if (distribution.reached[stateIdx])
+        this->entries.push_back(Entry{ (u16)stateIdx, distribution.probs[stateIdx] });
+    this->caughtProb = distribution.probs[power.n - 1];
+  }
+
+  /* Absolute probability that the pokemon is neither caught nor fled */
+  P GetOngoingProb() const
+  {
+    P sum(0);
+    for (const auto& entry : this->entries)
+      sum.Add(entry.prob);
+    return sum;
+  }
+
+  /* Returns the probability that the pokemon is caught if the player performs <actionByTurn>.
+     The longest repeated block of actionByTurn is applied with ApplyRepeatedActions, and runs of balls with ApplyBallRun. */
+  static P GetCatchProb(const std::vector<PlayerAction>& actionByTurn, const State& initialState = State())
+  {
+    BasicTransitionTable<P> table(initialState);
+    BasicStateDistribution distribution(table);
+
+    RepeatedBlock block = FindRepeatedBlock(actionByTurn);
+    size_t blockEnd = block.begin + block.length * block.repeatCount;
+    distribution.ApplyActions(actionByTurn, 0, block.begin);
+    if (block.repeatCount > 0)
+    {
+      std::vector<PlayerAction> blockActions(actionByTurn.begin() + block.begin, actionByTurn.begin() + block.begin + block.length);
+      distribution.ApplyRepeatedActions(blockActions, block.repeatCount);
+    }
+    distribution.ApplyActions(actionByTurn, blockEnd, actionByTurn.size());
+    return distribution.caughtProb;
+  }
+
+private:
+  /* Dense matrix of rowCount * n probabilities, row-major. reached[i] is false if probs[i] is known to be 0, so that
+     unreachable states are skipped (and not returned as entries). */
+  struct BlockMatrix
+  {
+    size_t rowCount;
+    size_t n;
+    std::vector<P> probs;
+    std::vector<bool> reached;
+
+    BlockMatrix(size_t rowCount, size_t n) :
+      rowCount(rowCount),
+      n(n),
+      probs(rowCount * n, P::ZERO),
+      reached(rowCount * n, false)
+    {}
+
+    void Set(size_t row, size_t col, const P& prob)
+    {
+      this->probs[row * this->n + col] = prob;
+      this->reached[row * this->n + col] = true;
+    }
+
+    BlockMatrix MulNew(const BlockMatrix& other) const
+    {
+      BlockMatrix res(this->rowCount, other.n);
+      for (size_t row = 0; row < this->rowCount; row++)
+        for (size_t k = 0; k < this->n; k++)
+        {
+          if (!this->reached[row * this->n + k])
+            continue;
+          const P& prob = this->probs[row * this->n + k];
+          for (size_t col = 0; col < other.n; col++)
+          {
+            if (!other.reached[k * other.n + col])
+              continue;
+            res.probs[row * res.n + col].Add(prob.MulNew(other.probs[k * other.n + col]));
+            res.reached[row * res.n + col] = true;
+          }
+        }
+      return res;
+    }
+  };
+
+  /* M[i][j] is the probability to be in state j after blockActions, starting from state i. The last row/column is the
+     caught state, which stays caught: M[caught][caught] = 1. Fled is not tracked, so the rows sum to 1 - P(flee). */
+  BlockMatrix GetBlockMatrix(const std::vector<PlayerAction>& blockActions) const
+  {
+    size_t stateCount = this->table->states.size();
+    BlockMatrix matrix(stateCount + 1, stateCount + 1);
+    for (size_t stateIdx = 0; stateIdx < stateCount; stateIdx++)
+    {
+      BasicStateDistribution distribution(*this->table);
+      distribution.entries[0].stateIdx = (u16)stateIdx;
+      distribution.ApplyActions(blockActions, 0, blockActions.size());
+
+      for (const auto& entry : distribution.entries)
+        matrix.Set(stateIdx, entry.stateIdx, entry.prob);
+      matrix.Set(stateIdx, stateCount, distribution.caughtProb);
+    }
+    matrix.Set(stateCount, stateCount, P::ONE);
+    return matrix;
+  }
+};
+
+using StateDistribution = BasicStateDistribution<Prob>;
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+
+#include "Types.hpp"
+#include "Actions.hpp"
+#include "Prob.hpp"
+#include "State.hpp"
+#include "Batch.hpp"
+#include "OptimalSearch.hpp"
+#include "ThreadPool.hpp"
+
+struct Species
+{
+  u8 catchRate;
+  u8 safariZoneFleeRate;
+};
+
+/*
+Species whose catchRate and safariZoneFleeRate reduce to the same safariCatchFactor and safariEscapeFactor.
+They always have the same catch probability, so it only needs to be computed once per class.
+Ex: The 65536 (catchRate, safariZoneFleeRate) pairs only form 21x19 classes.
+*/
+struct SpeciesClass
+{
+  State initialState;
+  std::vector<Species> members;
+
+  static std::vector<SpeciesClass> Group(const std::vector<Species>& speciesList)
+  {
+    std::vector<SpeciesClass> classes;
+    std::unordered_map<u32, size_t> classIndexByStateId;
+
+    for (const auto& species : speciesList)
+    {
+      State initialState(species.catchRate, species.safariZoneFleeRate);
+      auto [it, inserted] = classIndexByStateId.try_emplace(initialState.GetId(), classes.size());
+      if (inserted)
+        classes.push_back(SpeciesClass{ initialState, {} });
+      classes[it->second].members.push_back(species);
+    }
+    return classes;
+  }
+};
+
+/*
+Computes the catch probability of many species in one run, and writes one CSV line per species and actions:
+  catchRate,safariZoneFleeRate,catchProb,actions
+
+Each SpeciesClass is evaluated once, on the threads of a ThreadPool. Lines are written as soon as each class is done, so they are not in order.
+*/
+struct Sweep
+{
+  /* Every (catchRate, safariZoneFleeRate) pair, 256x256 */
+  static std::vector<Species> GetAllSpecies()
+  {
+    std::vector<Species> allSpecies;
+    for (u32 catchRate = 0; catchRate <= 255; catchRate++)
+      for (u32 safariZoneFleeRate = 0; safariZoneFleeRate <= 255; safariZoneFleeRate++)
+        allSpecies.push_back(Species{ (u8)catchRate, (u8)safariZoneFleeRate });
+    return allSpecies;
+  }
+
+  /* Evaluates every actionByTurn of <actionByTurnList> for each species, padded with ApplyBallCount(ballCount). See Batch.
+     The CSV lists the actions as given, not padded. */
+  static void EvaluateActions(const std::vector<Species>& speciesList, const std::vector<std::vector<PlayerAction>>& actionByTurnList, int ballCount,
+    FILE* csvFile, ThreadPool& threadPool)
+  {
+    std::vector<std::vector<PlayerAction>> paddedActionByTurnList;
+    for (const auto& actionByTurn : actionByTurnList)
+      paddedActionByTurnList.push_back(ApplyBallCount(actionByTurn, ballCount));
+
+    Run(speciesList, csvFile, threadPool, [&](const State& initialState)
+      {
+        auto catchProbs = Batch::GetCatchProbs(paddedActionByTurnList, initialState);
+
+        std::vector<OptimalSearch::Result> results;
+        for (size_t i = 0; i < actionByTurnList.size(); i++)
+          results.push_back(OptimalSearch::Result{ actionByTurnList[i], catchProbs[i] });
+        return results;
+      });
+  }
+
+  /* Searches the best actions of each species. See OptimalSearch. */
+  static void SearchOptimalActions(const std::vector<Species>& speciesList, int ballCount, int maxTurnCount, FILE* csvFile, ThreadPool& threadPool)
+  {
+    Run(speciesList, csvFile, threadPool, [&](const State& initialState)
+      {
+        return std::vector<OptimalSearch::Result>{ OptimalSearch(ballCount, maxTurnCount, initialState).Run() };
+      });
+  }
+
+private:
+  template<typename F>
+  static void Run(const std::vector<Species>& speciesList, FILE* csvFile, ThreadPool& threadPool, F&& evaluate)
+  {
+    std::mutex csvMutex;
+
+    fprintf(csvFile, "catchRate,safariZoneFleeRate,catchProb,actions\n");
+
+    auto classes = SpeciesClass::Group(speciesList);
+
+    threadPool.ParallelFor(classes.size(), [&](size_t classIdx)
+      {
+        const SpeciesClass& speciesClass = classes[classIdx];
+        std::vector<OptimalSearch::Result> results = evaluate(speciesClass.initialState);
+
+        std::lock_guard<std::mutex> lock(csvMutex);
+        for (const auto& result : results)
+        {
+          std::string actionsStr = ActionsToStr(result.actionByTurn);
+          for (const auto& species : speciesClass.members)
+            fprintf(csvFile, "%d,%d,%.17g,%s\n", species.catchRate, species.safariZoneFleeRate, result.catchProb.ToFloat(), actionsStr.c_str());
+        }
+        fflush(csvFile);
+      });
+  }
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+
+/*
+Threads created once and reused by every parallel computation (Node graph, sweep, etc.).
+
+Only depends on std::thread. std::execution::par is avoided because with GCC/libstdc++, it silently runs on a single thread unless TBB is installed and linked.
+*/
+struct ThreadPool
+{
+  /* 0 means one thread per core. The calling thread counts as one of them. */
+  ThreadPool(size_t threadCount = 0)
+  {
+    if (threadCount == 0)
+      threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    this->threadCount = threadCount;
+    for (size_t i = 1; i < threadCount; i++)
+      this->threads.emplace_back([this, i]() { ThreadLoop(i); });
+  }
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->stopping = true;
+    }
+    this->jobReady.notify_all();
+    for (auto& thread : this->threads)
+      thread.join();
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t GetThreadCount() const
+  {
+    return this->threadCount;
+  }
+
+  /* Calls job(threadIdx) once on every thread, threadIdx in [0, GetThreadCount()). Returns once they all returned.
+     The calling thread runs threadIdx 0. */
+  void RunOnAllThreads(const std::function<void(size_t)>& job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->job = &job;
+      this->runningThreadCount = this->threads.size();
+      this->jobId++;
+    }
+    this->jobReady.notify_all();
+
+    job(0);
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->jobDone.wait(lock, [this]() { return this->runningThreadCount == 0; });
+    this->job = nullptr;
+  }
+
+  /* Calls fn(i) for every i in [0, count). Each thread takes the next i as soon as it is done with the previous one. */
+  template<typename F>
+  void ParallelFor(size_t count, F&& fn)
+  {
+    std::atomic<size_t> nextIdx = 0;
+    RunOnAllThreads([&](size_t)
+      {
+        for (size_t i = nextIdx++; i < count; i = nextIdx++)
+          fn(i);
+      });
+  }
+
+private:
+  size_t threadCount = 1;
+  std::vector<std::thread> threads;
+
+  std::mutex mutex;
+  std::condition_variable jobReady;
+  std::condition_variable jobDone;
+  const std::function<void(size_t)>* job = nullptr;
+  /* Incremented for every job, so a thread knows whether it already ran the current one */
+  size_t jobId = 0;
+  size_t runningThreadCount = 0;
+  bool stopping = false;
+
+  void ThreadLoop(size_t threadIdx)
+  {
+    size_t lastJobId = 0;
+    while (true)
+    {
+      const std::function<void(size_t)>* currentJob;
+      {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->jobReady.wait(lock, [&]() { return this->stopping || this->jobId != lastJobId; });
+        if (this->stopping)
+          return;
+        lastJobId = this->jobId;
+        currentJob = this->job;
+      }
+
+      (*currentJob)(threadIdx);
+
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (--this->runningThreadCount == 0)
+        this->jobDone.notify_one();
+    }
+  }
+};
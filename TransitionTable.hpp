@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include "Types.hpp"
+#include "Prob.hpp"
+#include "State.hpp"
+
+/*
+Every outcome of every player action, for every State reachable from the initial state of a species.
+
+Built once per species, so engines don't need to call GetStayFleeProb, GetCatchMissProb, ForEachPlayerActionValue
+and ApplyActions for every node: they only walk the list of outcomes of (stateIdx, playerAction).
+
+Ex: For Chansey, 72 states are reachable. (stateIdx 0, bait) has 10 outcomes: flee or watch carefully, for each bait counter from 2 to 6.
+
+P is the probability type (Prob by default, see BasicProb).
+*/
+template<typename P>
+struct BasicTransitionTable
+{
+  struct Outcome
+  {
+    /* Probability of this outcome, given the state and player action. Ex: For watchCarefully after bait 3, it is P(bait 3) * P(stay) */
+    P prob;
+    /* State after the turn. Only meaningful for watchCarefully. */
+    u16 nextStateIdx;
+    /* caught, flee or watchCarefully */
+    PokemonAction pokemonAction;
+  };
+
+  /* states[0] is the initial state */
+  std::vector<State> states;
+
+  BasicTransitionTable(const State& initialState)
+  {
+    std::unordered_map<u32, u16> stateIdxById;
+
+    auto GetStateIdx = [&](const State& state)
+    {
+      auto [it, inserted] = stateIdxById.try_emplace(state.GetId(), (u16)this->states.size());
+      if (inserted)
+        this->states.push_back(state);
+      return it->second;
+    };
+
+    GetStateIdx(initialState);
+
+    // this->states grows while new states are discovered
+    for (size_t stateIdx = 0; stateIdx < this->states.size(); stateIdx++)
+    {
+      for (auto playerAction : { PlayerAction::ball, PlayerAction::bait, PlayerAction::rock })
+      {
+        this->outcomeOffsets.push_back((u32)this->outcomes.size());
+
+        State state = this->states[stateIdx];
+        const auto& [stayProb, fleeProb] = state.GetStayFleeProb<P>();
+
+        state.ForEachPlayerActionValue<P>(playerAction, [&](u8 playerValue, const P& playerActionProb)
+          {
+            if (playerAction == PlayerAction::ball && playerValue == 1)
+            {
+              this->outcomes.push_back(Outcome{ playerActionProb, (u16)stateIdx, PokemonAction::caught });
+              return;
+            }
+
+            this->outcomes.push_back(Outcome{ playerActionProb.MulNew(fleeProb), (u16)stateIdx, PokemonAction::flee });
+
+            u16 nextStateIdx = GetStateIdx(state.ApplyActions(playerAction, playerValue, PokemonAction::watchCarefully));
+            this->outcomes.push_back(Outcome{ playerActionProb.MulNew(stayProb), nextStateIdx, PokemonAction::watchCarefully });
+          });
+      }
+    }
+    this->outcomeOffsets.push_back((u32)this->outcomes.size());
+  }
+
+  const Outcome* BeginOutcomes(u16 stateIdx, PlayerAction playerAction) const
+  {
+    return this->outcomes.data() + this->outcomeOffsets[stateIdx * 3 + playerAction];
+  }
+
+  const Outcome* EndOutcomes(u16 stateIdx, PlayerAction playerAction) const
+  {
+    return this->outcomes.data() + this->outcomeOffsets[stateIdx * 3 + playerAction + 1];
+  }
+
+private:
+  std::vector<Outcome> outcomes;
+  /* Outcomes of (stateIdx, playerAction) are outcomes[outcomeOffsets[stateIdx * 3 + playerAction]] to outcomes[outcomeOffsets[stateIdx * 3 + playerAction + 1] - 1] */
+  std::vector<u32> outcomeOffsets;
+};
+
+using TransitionTable = BasicTransitionTable<Prob>;
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+#include "ThreadPool.hpp"
+
+/*
+Runs tasks on the threads of a ThreadPool. Each thread has its own queue of tasks:
+  - A thread processes the newest task of its own queue first (depth-first, good cache locality).
+  - When its queue is empty, it steals the oldest task of another thread (usually the biggest remaining subtree).
+
+A task can spawn new tasks while being processed, so work is only split where it is needed,
+and a thread that finishes early (ex: its subtree ended with a catch or flee) steals work instead of staying idle.
+A thread that finds no task in any queue sleeps until a task is spawned, instead of spinning on the queue mutexes.
+*/
+template<typename Task>
+struct WorkStealingScheduler
+{
+  struct Worker
+  {
+    WorkStealingScheduler* scheduler = nullptr;
+    size_t idx = 0;
+    std::deque<Task> tasks;
+    std::mutex mutex;
+
+    /* Adds a task that will be processed by this thread, or stolen by another. */
+    void Spawn(Task task)
+    {
+      this->scheduler->pendingTaskCount++;
+      this->scheduler->queuedTaskCount++; // Before the push, so that it never goes below the number of queued tasks
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->tasks.push_back(std::move(task));
+      }
+      this->scheduler->WakeIdleWorker();
+    }
+  };
+
+  WorkStealingScheduler(ThreadPool& threadPool) :
+    threadPool(threadPool)
+  {
+    for (size_t i = 0; i < threadPool.GetThreadCount(); i++)
+    {
+      this->workers.push_back(std::make_unique<Worker>());
+      this->workers.back()->scheduler = this;
+      this->workers.back()->idx = i;
+    }
+  }
+
+  size_t GetThreadCount() const
+  {
+    return this->workers.size();
+  }
+
+  /* Processes <rootTask> and every task it spawns, and returns once they are all done.
+     process(Task& task, Worker& worker) is called once per task. worker.idx is in [0, GetThreadCount()). */
+  template<typename F>
+  void Run(Task rootTask, F&& process)
+  {
+    this->workers[0]->Spawn(std::move(rootTask));
+
+    this->threadPool.RunOnAllThreads([&](size_t threadIdx) { WorkLoop(*this->workers[threadIdx], process); });
+  }
+
+private:
+  ThreadPool& threadPool;
+  std::vector<std::unique_ptr<Worker>> workers;
+  /* Tasks spawned but not fully processed yet. Once it reaches 0, no new task can appear. */
+  std::atomic<size_t> pendingTaskCount = 0;
+  /* Tasks in the queues, not taken by a thread yet */
+  std::atomic<size_t> queuedTaskCount = 0;
+
+  /* Threads that found no task sleep on taskAvailable */
+  std::mutex idleMutex;
+  std::condition_variable taskAvailable;
+  std::atomic<size_t> idleWorkerCount = 0;
+
+  void WakeIdleWorker()
+  {
+    // A thread that is about to sleep increments idleWorkerCount, then checks queuedTaskCount with idleMutex locked,
+    // so either it sees the new task, or it is seen here and woken up
+    if (this->idleWorkerCount == 0)
+      return;
+    {
+      std::lock_guard<std::mutex> lock(this->idleMutex);
+    }
+    this->taskAvailable.notify_one();
+  }
+
+  void WaitForTask()
+  {
+    std::unique_lock<std::mutex> lock(this->idleMutex);
+    this->idleWorkerCount++;
+    this->taskAvailable.wait(lock, [&]() { return this->queuedTaskCount != 0 || this->pendingTaskCount == 0; });
+    this->idleWorkerCount--;
+  }
+
+  template<typename F>
+  void WorkLoop(Worker& worker, F& process)
+  {
+    Task task;
+    while (this->pendingTaskCount != 0)
+    {
+      if (!PopOwnTask(worker, task) && !StealTask(worker, task))
+      {
+        WaitForTask();
+        continue;
+      }
+
+      process(task, worker);
+      if (--this->pendingTaskCount == 0)
+      {
+        // Every task is done: wake up all sleeping threads so that they return
+        std::lock_guard<std::mutex> lock(this->idleMutex);
+        this->taskAvailable.notify_all();
+      }
+    }
+  }
+
+  bool PopOwnTask(Worker& worker, Task& task)
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty())
+      return false;
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    this->queuedTaskCount--;
+    return true;
+  }
+
+  bool StealTask(Worker& worker, Task& task)
+  {
+    for (size_t i = 1; i < this->workers.size(); i++)
+    {
+      Worker& victim = *this->workers[(worker.idx + i) % this->workers.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (victim.tasks.empty())
+        continue;
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      this->queuedTaskCount--;
+      return true;
+    }
+    return false;
+  }
+};
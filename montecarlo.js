@@ -63,8 +63,9 @@ class State {
   HandleAction_SafariZoneBallThrow() {
     this.ballThrowCount++;
     let ballMultiplier = 15;
-    let catchRate = (this.safariCatchFactor * 1275 / 100);
-    let odds = catchRate * ballMultiplier / 30;
+    // Integer divisions, like the game
+    let catchRate = (this.safariCatchFactor * 1275 / 100) | 0;
+    let odds = (catchRate * ballMultiplier / 30) | 0;
 
     if (odds > 254)
       return true; //caught